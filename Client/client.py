@@ -105,6 +105,22 @@ def action_search_any():
         print("  ", p)
 
 
+def action_query():
+    line = input("Введи булевий запит для QUERY (напр. (a OR b) AND c AND NOT d): ").strip()
+    if not line:
+        print("Запит не може бути порожнім.")
+        return
+    resp = send_request("QUERY " + line)
+    ok, paths = parse_search_response(resp)
+    if not ok:
+        print("Помилка або пустий результат. Сирий респонс:")
+        print(resp)
+        return
+    print(f"Знайдено {len(paths)} документ(ів):")
+    for p in paths:
+        print("  ", p)
+
+
 def action_add_file():
     path = input("Введи повний шлях до файлу для ADD_FILE: ").strip()
     if not path:
@@ -145,6 +161,12 @@ def action_has_file():
     print(resp)
 
 
+def action_stats():
+    fmt = input("Формат (порожньо - короткий, p - Prometheus): ").strip().lower()
+    resp = send_request("STATS PROMETHEUS" if fmt == "p" else "STATS")
+    print(resp)
+
+
 def print_menu():
     print()
     print("=== Меню клієнта ===")
@@ -155,6 +177,8 @@ def print_menu():
     print("5) REMOVE_FILE")
     print("6) REINDEX_FILE")
     print("7) HAS_FILE")
+    print("8) QUERY (булевий запит: AND / OR / NOT, дужки)")
+    print("9) STATS (метрики сервера)")
     print("0) Вихід")
 
 
@@ -180,6 +204,10 @@ def main():
             action_reindex_file()
         elif choice == "7":
             action_has_file()
+        elif choice == "8":
+            action_query()
+        elif choice == "9":
+            action_stats()
         else:
             print("Невірний вибір, спробуй ще раз.")
 
@@ -0,0 +1,1099 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "server.h"
+#include "corpus_generator.h"
+#include "inverted_index.h"
+#include "tcp_client.h"
+
+// Набір бенчмарків:
+//   мікро:    токенізація (ASCII і UTF-8), інтернування слів у IdValueTable, вставка/перетин/об'єднання PostingList;
+//   наскрізні: індексація корпусу через IndexManager, пропускна здатність запитів,
+//              навантаження на Server через сокети з p50 / p99 / p999,
+//              те саме через координатор над кількома шардами на localhost,
+//              наздоганяння реплік (журнал змін і знімок) на localhost,
+//              пошук пулом, закріпленим за NUMA-вузлами, з копіями індексу на вузлах,
+//              поведінка під перевантаженням (ERROR BUSY / ERROR TIMEOUT),
+//              індексація в дрібні сегменти з фоновими злиттями.
+// Результати пишуться у JSON (--out), щоб порівнювати релізи між собою.
+
+namespace {
+
+struct BenchOptions {
+    CorpusConfig corpus;
+    unsigned int threads       = 0;
+    std::size_t  queries       = 20000;
+    std::size_t  wordsPerQuery = 3;
+    std::size_t  clients       = 8;
+    std::size_t  socketQueries = 4000;
+    std::size_t  shards        = 3;
+    unsigned int numaEmulate   = 0;
+    std::string  corpusDir;
+    std::string  outPath;
+    std::string  only;
+    bool         keepCorpus    = false;
+};
+
+struct BenchResult {
+    std::string                                   name;
+    std::uint64_t                                 operations = 0;
+    double                                        seconds    = 0.0;
+    std::vector<std::pair<std::string, double>>   extra;
+    bool                                          hasLatency = false;
+    metrics::LatencyHistogram::Snapshot           latency;
+};
+
+double elapsedSeconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Не дає компілятору викинути обчислення.
+volatile std::size_t g_sink = 0;
+
+void printUsage() {
+    std::cout
+        << "Usage: cw_bench [options]\n"
+        << "  --docs N            documents in the synthetic corpus (default 10000)\n"
+        << "  --vocab N           vocabulary size (default 50000)\n"
+        << "  --words-per-doc N   words per document (default 200)\n"
+        << "  --zipf S            Zipf exponent (default 1.0)\n"
+        << "  --seed N            RNG seed (default 42)\n"
+        << "  --threads N         worker threads, 0 = hardware concurrency\n"
+        << "  --queries N         in-process queries (default 20000)\n"
+        << "  --clients N         socket load clients (default 8)\n"
+        << "  --socket-queries N  total socket requests (default 4000)\n"
+        << "  --shards N          shard servers behind the coordinator (default 3)\n"
+        << "  --numa-emulate N    split CPUs into N emulated NUMA nodes (default: real topology)\n"
+        << "  --corpus-dir DIR    where to write corpus files (default: temp dir)\n"
+        << "  --keep-corpus       do not delete the corpus directory\n"
+        << "  --only NAME         run benchmarks whose name starts with NAME\n"
+        << "  --quick             small corpus for smoke runs\n"
+        << "  --out FILE          write JSON results to FILE (default stdout)\n";
+}
+
+bool parseOptions(int argc, char** argv, BenchOptions& opt) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << "\n";
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--docs") {
+            opt.corpus.documents = std::strtoull(next(), nullptr, 10);
+        } else if (arg == "--vocab") {
+            opt.corpus.vocabulary = std::strtoull(next(), nullptr, 10);
+        } else if (arg == "--words-per-doc") {
+            opt.corpus.wordsPerDoc = std::strtoull(next(), nullptr, 10);
+        } else if (arg == "--zipf") {
+            opt.corpus.zipfExponent = std::strtod(next(), nullptr);
+        } else if (arg == "--seed") {
+            opt.corpus.seed = std::strtoull(next(), nullptr, 10);
+        } else if (arg == "--threads") {
+            opt.threads = static_cast<unsigned int>(std::strtoul(next(), nullptr, 10));
+        } else if (arg == "--queries") {
+            opt.queries = std::strtoull(next(), nullptr, 10);
+        } else if (arg == "--clients") {
+            opt.clients = std::strtoull(next(), nullptr, 10);
+        } else if (arg == "--socket-queries") {
+            opt.socketQueries = std::strtoull(next(), nullptr, 10);
+        } else if (arg == "--shards") {
+            opt.shards = std::strtoull(next(), nullptr, 10);
+        } else if (arg == "--numa-emulate") {
+            opt.numaEmulate = static_cast<unsigned int>(std::strtoul(next(), nullptr, 10));
+        } else if (arg == "--corpus-dir") {
+            opt.corpusDir = next();
+        } else if (arg == "--keep-corpus") {
+            opt.keepCorpus = true;
+        } else if (arg == "--only") {
+            opt.only = next();
+        } else if (arg == "--out") {
+            opt.outPath = next();
+        } else if (arg == "--quick") {
+            opt.corpus.documents   = 500;
+            opt.corpus.vocabulary  = 5000;
+            opt.corpus.wordsPerDoc = 100;
+            opt.queries            = 1000;
+            opt.clients            = 2;
+            opt.socketQueries      = 200;
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage();
+            std::exit(0);
+        } else {
+            std::cerr << "Unknown option " << arg << "\n";
+            printUsage();
+            return false;
+        }
+    }
+    if (opt.corpus.documents == 0 || opt.corpus.vocabulary == 0 || opt.clients == 0 || opt.shards == 0) {
+        std::cerr << "--docs, --vocab, --clients and --shards must be positive\n";
+        return false;
+    }
+    return true;
+}
+
+std::string jsonEscape(const std::string& s) {
+    std::string out;
+    for (char ch : s) {
+        if (ch == '"' || ch == '\\') {
+            out.push_back('\\');
+        }
+        out.push_back(ch);
+    }
+    return out;
+}
+
+std::string renderJson(const BenchOptions& opt, unsigned int threads, const std::vector<BenchResult>& results) {
+    std::ostringstream oss;
+    oss.precision(6);
+    oss << std::fixed;
+    oss << "{\n";
+    oss << "  \"schema\": 1,\n";
+    oss << "  \"config\": {\n";
+    oss << "    \"documents\": " << opt.corpus.documents << ",\n";
+    oss << "    \"vocabulary\": " << opt.corpus.vocabulary << ",\n";
+    oss << "    \"words_per_doc\": " << opt.corpus.wordsPerDoc << ",\n";
+    oss << "    \"zipf_exponent\": " << opt.corpus.zipfExponent << ",\n";
+    oss << "    \"seed\": " << opt.corpus.seed << ",\n";
+    oss << "    \"threads\": " << threads << ",\n";
+    oss << "    \"queries\": " << opt.queries << ",\n";
+    oss << "    \"words_per_query\": " << opt.wordsPerQuery << ",\n";
+    oss << "    \"clients\": " << opt.clients << ",\n";
+    oss << "    \"socket_queries\": " << opt.socketQueries << ",\n";
+    oss << "    \"shards\": " << opt.shards << "\n";
+    oss << "  },\n";
+    oss << "  \"results\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        double opsPerSec = r.seconds > 0 ? static_cast<double>(r.operations) / r.seconds : 0.0;
+        double nsPerOp   = r.operations > 0 ? r.seconds * 1e9 / static_cast<double>(r.operations) : 0.0;
+
+        oss << "    {\"name\": \"" << jsonEscape(r.name) << "\""
+            << ", \"operations\": " << r.operations
+            << ", \"seconds\": " << r.seconds
+            << ", \"ops_per_sec\": " << opsPerSec
+            << ", \"ns_per_op\": " << nsPerOp;
+        for (const auto& kv : r.extra) {
+            oss << ", \"" << jsonEscape(kv.first) << "\": " << kv.second;
+        }
+        if (r.hasLatency) {
+            oss << ", \"p50_us\": " << static_cast<double>(r.latency.percentile(0.50)) / 1e3
+                << ", \"p99_us\": " << static_cast<double>(r.latency.percentile(0.99)) / 1e3
+                << ", \"p999_us\": " << static_cast<double>(r.latency.percentile(0.999)) / 1e3
+                << ", \"max_us\": " << static_cast<double>(r.latency.max) / 1e3;
+        }
+        oss << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    oss << "  ]\n";
+    oss << "}\n";
+    return oss.str();
+}
+
+class BenchSuite {
+public:
+    BenchSuite(const BenchOptions& opt, ThreadPool& pool)
+        : opt(opt)
+        , pool(pool)
+        , failed(false)
+    {}
+
+    // false, якщо наскрізна перевірка коректності не пройшла.
+    bool passed() const {
+        return !failed;
+    }
+
+    void run(std::vector<BenchResult>& results) {
+        CorpusGenerator generator(opt.corpus);
+        docs = generator.generateDocuments();
+
+        runIf("tokenize", results, [&](BenchResult& r) { benchTokenize<analysis::DefaultAnalyzer>(r, docs); });
+        runIf("tokenize_ascii", results, [&](BenchResult& r) { benchTokenize<analysis::AsciiAnalyzer>(r, docs); });
+        runIf("tokenize_utf8", results, [&](BenchResult& r) { benchTokenizeUtf8(r); });
+        runIf("intern_words", results, [&](BenchResult& r) { benchIntern(r); });
+        runIf("posting_insert", results, [&](BenchResult& r) { benchPostingInsert(r); });
+        runIf("posting_intersect", results, [&](BenchResult& r) { benchPostingIntersect(r); });
+        runIf("posting_union", results, [&](BenchResult& r) { benchPostingUnion(r); });
+
+        bool needIndex = wants("ingest") || wants("query") || wants("socket") || wants("cluster")
+                      || wants("replication") || wants("numa");
+        if (!needIndex) {
+            return;
+        }
+        if (!prepareCorpusFiles()) {
+            std::cerr << "Cannot write corpus to " << corpusDir << "\n";
+            return;
+        }
+
+        runIf("ingest", results, [&](BenchResult& r) { benchIngest(r); });
+        runIf("ingest_segmented", results, [&](BenchResult& r) { benchSegments(r); });
+        runIf("query_single", results, [&](BenchResult& r) { benchQueries(r, 1, false); });
+        runIf("query_all", results, [&](BenchResult& r) { benchQueries(r, opt.wordsPerQuery, true); });
+        runIf("query_any", results, [&](BenchResult& r) { benchQueries(r, opt.wordsPerQuery, false); });
+        runIf("socket_search_any", results, [&](BenchResult& r) { benchSocket(r); });
+        runIf("socket_overload", results, [&](BenchResult& r) { benchOverload(r); });
+        runIf("cluster_search_any", results, [&](BenchResult& r) { benchCluster(r); });
+        runIf("replication_catchup", results, [&](BenchResult& r) { benchReplication(r); });
+        runIf("numa_query_any", results, [&](BenchResult& r) { benchNuma(r); });
+
+        if (!opt.keepCorpus && opt.corpusDir.empty()) {
+            std::error_code ec;
+            std::filesystem::remove_all(corpusDir, ec);
+        }
+    }
+
+private:
+    bool wants(const std::string& name) const {
+        return opt.only.empty() || name.compare(0, opt.only.size(), opt.only) == 0
+            || opt.only.compare(0, name.size(), name) == 0;
+    }
+
+    void runIf(const std::string& name, std::vector<BenchResult>& results,
+               const std::function<void(BenchResult&)>& body) {
+        if (!opt.only.empty() && name.compare(0, opt.only.size(), opt.only) != 0) {
+            return;
+        }
+        BenchResult r;
+        r.name = name;
+        body(r);
+        std::cerr << name << ": " << r.operations << " ops in " << r.seconds << " s\n";
+        results.push_back(std::move(r));
+    }
+
+    template <typename Analyzer>
+    void benchTokenize(BenchResult& r, const std::vector<std::string>& texts) {
+        std::size_t bytes  = 0;
+        std::size_t tokens = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (const std::string& text : texts) {
+            Analyzer::analyze(text, [&](const std::string&) {
+                ++tokens;
+            });
+            bytes += text.size();
+        }
+        r.seconds    = elapsedSeconds(start);
+        r.operations = tokens;
+        r.extra.push_back({"mb_per_sec", static_cast<double>(bytes) / 1e6 / r.seconds});
+        g_sink = g_sink + tokens;
+    }
+
+    // Той самий корпус кирилицею (кожне п'яте слово великими літерами) через
+    // UTF-8 аналізатор. Кількість термів має збігтися з ASCII-корпусом, а
+    // контрольний рядок - дати очікувані терми для обох UTF-8 конфігурацій.
+    void benchTokenizeUtf8(BenchResult& r) {
+        static const char* const lower[26] = {
+            "а", "б", "в", "г", "ґ", "д", "е", "є", "ж", "з", "и", "і", "ї",
+            "й", "к", "л", "м", "н", "о", "п", "р", "с", "т", "у", "ф", "х",
+        };
+        static const char* const upper[26] = {
+            "А", "Б", "В", "Г", "Ґ", "Д", "Е", "Є", "Ж", "З", "И", "І", "Ї",
+            "Й", "К", "Л", "М", "Н", "О", "П", "Р", "С", "Т", "У", "Ф", "Х",
+        };
+        std::vector<std::string> cyrillic;
+        cyrillic.reserve(docs.size());
+        std::size_t asciiTokens = 0;
+        for (const std::string& doc : docs) {
+            std::string text;
+            text.reserve(doc.size() * 2);
+            std::size_t word = 0;
+            for (std::size_t i = 0; i < doc.size(); ++i) {
+                char ch = doc[i];
+                if (ch >= 'a' && ch <= 'z') {
+                    text += (word % 5 == 0 ? upper : lower)[ch - 'a'];
+                } else {
+                    text.push_back(ch);
+                    if (i > 0 && doc[i - 1] >= 'a' && doc[i - 1] <= 'z') {
+                        ++word;
+                    }
+                }
+            }
+            cyrillic.push_back(std::move(text));
+            analysis::AsciiAnalyzer::analyze(doc, [&](const std::string&) {
+                ++asciiTokens;
+            });
+        }
+
+        benchTokenize<analysis::UnicodeAnalyzer>(r, cyrillic);
+
+        // "Київ, ҐАНОК і М’ЯСО! ЧАЙ" з розкладеним Й (И + U+0306).
+        const std::string sample = "Київ, ҐАНОК і М\xE2\x80\x99ЯСО! ЧАИ\xCC\x86";
+        bool unicodeOk = analysis::UnicodeAnalyzer::terms(sample)
+                      == std::vector<std::string>({"київ", "ґанок", "і", "м'ясо", "чай"});
+        bool ukrainianOk = analysis::UkrainianAnalyzer::terms(sample)
+                        == std::vector<std::string>({"київ", "ґанок", "м'яс", "чай"});
+        bool countOk = r.operations == asciiTokens;
+        if (!unicodeOk || !ukrainianOk || !countOk) {
+            std::cerr << "utf8 tokenize check failed: unicode " << unicodeOk << ", ukrainian " << ukrainianOk
+                      << ", terms " << r.operations << " vs " << asciiTokens << "\n";
+            failed = true;
+        }
+    }
+
+    void benchIntern(BenchResult& r) {
+        std::vector<std::string> tokens;
+        for (const std::string& doc : docs) {
+            analysis::DefaultAnalyzer::analyze(doc, [&](const std::string& term) {
+                tokens.push_back(term);
+            });
+        }
+
+        IdValueTable<std::string> table;
+        auto start = std::chrono::steady_clock::now();
+        for (const std::string& token : tokens) {
+            g_sink = g_sink + table.add(token);
+        }
+        r.seconds    = elapsedSeconds(start);
+        r.operations = tokens.size();
+        r.extra.push_back({"distinct_words", static_cast<double>(table.size())});
+    }
+
+    // Списки документів для кожного рангу слова, побудовані з корпусу.
+    void buildRankPostings() {
+        if (!rankPostings.empty()) {
+            return;
+        }
+        IdValueTable<std::string> table;
+        std::vector<PostingList> byWord;
+        for (std::size_t docId = 0; docId < docs.size(); ++docId) {
+            for (const std::string& word : analysis::DefaultAnalyzer::terms(docs[docId])) {
+                unsigned int wordId = table.add(word);
+                if (wordId >= byWord.size()) {
+                    byWord.resize(wordId + 1);
+                }
+                byWord[wordId].add(static_cast<unsigned int>(docId));
+            }
+        }
+        rankPostings.reserve(opt.corpus.vocabulary);
+        for (std::size_t rank = 0; rank < opt.corpus.vocabulary; ++rank) {
+            unsigned int wordId = 0;
+            if (table.getId(CorpusGenerator::wordForRank(rank), wordId)) {
+                rankPostings.push_back(byWord[wordId]);
+            } else {
+                rankPostings.push_back(PostingList());
+            }
+        }
+    }
+
+    // Запис постингів тим шляхом, що й у сервері: SegmentedIndex::addDocument по
+    // документу, зі скиданням сегментів і фоновими злиттями (час - до їх кінця).
+    // Плоский InvertedIndex під одним блокуванням - лише еталон (reference_*).
+    void benchPostingInsert(BenchResult& r) {
+        std::vector<std::unordered_set<unsigned int>> docWords(docs.size());
+        std::size_t postings = 0;
+        CorpusGenerator generator(opt.corpus);
+        for (std::unordered_set<unsigned int>& words : docWords) {
+            for (std::size_t i = 0; i < opt.corpus.wordsPerDoc; ++i) {
+                words.insert(static_cast<unsigned int>(generator.sampleRank()));
+            }
+            postings += words.size();
+        }
+
+        SegmentedIndex index;
+        index.setMergePool(&pool);
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t docId = 0; docId < docWords.size(); ++docId) {
+            index.addDocument(static_cast<unsigned int>(docId), docWords[docId]);
+        }
+        index.waitForMerges();
+        r.seconds    = elapsedSeconds(start);
+        r.operations = postings;
+        r.extra.push_back({"posting_bytes", static_cast<double>(index.memoryUsage())});
+        r.extra.push_back({"segments", static_cast<double>(index.segmentCount())});
+
+        InvertedIndex reference;
+        start = std::chrono::steady_clock::now();
+        for (std::size_t docId = 0; docId < docWords.size(); ++docId) {
+            for (unsigned int wordId : docWords[docId]) {
+                reference.addPosting(wordId, static_cast<unsigned int>(docId));
+            }
+        }
+        r.extra.push_back({"reference_seconds", elapsedSeconds(start)});
+        r.extra.push_back({"reference_posting_bytes", static_cast<double>(reference.memoryUsage())});
+    }
+
+    void benchPostingIntersect(BenchResult& r) {
+        buildRankPostings();
+        CorpusGenerator generator(opt.corpus);
+        std::size_t rounds = opt.queries;
+
+        metrics::LatencyHistogram hist;
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < rounds; ++i) {
+            const PostingList& a = rankPostings[generator.sampleRank()];
+            const PostingList& b = rankPostings[generator.sampleRank()];
+            std::uint64_t t0 = metrics::nowNanos();
+            PostingList result = PostingList::intersect(a, b);
+            hist.record(metrics::nowNanos() - t0);
+            g_sink = g_sink + result.cardinality();
+        }
+        r.seconds    = elapsedSeconds(start);
+        r.operations = rounds;
+        r.hasLatency = true;
+        r.latency    = hist.snapshot();
+    }
+
+    void benchPostingUnion(BenchResult& r) {
+        buildRankPostings();
+        CorpusGenerator generator(opt.corpus);
+        std::size_t rounds = opt.queries;
+
+        metrics::LatencyHistogram hist;
+        std::vector<unsigned int> out;
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < rounds; ++i) {
+            posting_ops::PostingRefs lists;
+            for (std::size_t k = 0; k < opt.wordsPerQuery; ++k) {
+                const PostingList& list = rankPostings[generator.sampleRank()];
+                if (!list.empty()) {
+                    lists.push_back(&list);
+                }
+            }
+            std::uint64_t t0 = metrics::nowNanos();
+            posting_ops::unionPostings(lists, out, &pool);
+            hist.record(metrics::nowNanos() - t0);
+            g_sink = g_sink + out.size();
+        }
+        r.seconds    = elapsedSeconds(start);
+        r.operations = rounds;
+        r.hasLatency = true;
+        r.latency    = hist.snapshot();
+    }
+
+    bool prepareCorpusFiles() {
+        if (!opt.corpusDir.empty()) {
+            corpusDir = opt.corpusDir;
+        } else {
+            corpusDir = (std::filesystem::temp_directory_path()
+                         / ("cw_bench_corpus_" + std::to_string(opt.corpus.seed))).string();
+        }
+        std::error_code ec;
+        std::filesystem::create_directories(corpusDir, ec);
+        return CorpusGenerator::writeDocuments(docs, corpusDir, docPaths);
+    }
+
+    void benchIngest(BenchResult& r) {
+        index = std::make_unique<IndexManager>();
+        index->setThreadPool(&pool);
+
+        std::size_t bytes = 0;
+        for (const std::string& doc : docs) {
+            bytes += doc.size();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        unsigned int added = index->addFiles(docPaths, pool);
+        r.seconds    = elapsedSeconds(start);
+        r.operations = added;
+        index->waitForMerges();
+        r.extra.push_back({"mb_per_sec", static_cast<double>(bytes) / 1e6 / r.seconds});
+        r.extra.push_back({"words", static_cast<double>(index->wordCount())});
+        r.extra.push_back({"posting_bytes", static_cast<double>(index->postingMemoryUsage())});
+    }
+
+    // Індексація з малим змінним сегментом: багато скидань і фонових злиттів.
+    // Результати мають збігатися з індексом зі звичайними налаштуваннями -
+    // і одразу після видалень/переіндексацій (злиття ще йдуть), і після злиттів.
+    void benchSegments(BenchResult& r) {
+        ensureIndex();
+
+        std::size_t postings = docs.size() * opt.corpus.wordsPerDoc;
+        IndexManager segmented;
+        segmented.setThreadPool(&pool);
+        segmented.setSegmentPolicy(std::max<std::size_t>(1024, postings / 64), 4);
+
+        metrics::Counter& merges = metrics::registry().counter(
+            "cw_segment_merges_total", "Completed background segment merges");
+        std::uint64_t mergesBefore = merges.value();
+
+        auto start = std::chrono::steady_clock::now();
+        unsigned int added = segmented.addFiles(docPaths, pool);
+        r.seconds    = elapsedSeconds(start);
+        r.operations = added;
+
+        CorpusGenerator generator(opt.corpus);
+        std::vector<std::vector<std::string>> queries;
+        for (std::size_t i = 0; i < 50; ++i) {
+            queries.push_back(generator.nextQuery(opt.wordsPerQuery));
+        }
+        std::size_t mismatches = 0;
+        auto compare = [&]() {
+            for (const auto& query : queries) {
+                std::vector<std::string> expected;
+                std::vector<std::string> actual;
+                index->searchAnyWord(query, expected);
+                segmented.searchAnyWord(query, actual);
+                if (actual != expected) {
+                    ++mismatches;
+                }
+                index->searchAllWords(query, expected);
+                segmented.searchAllWords(query, actual);
+                if (actual != expected) {
+                    ++mismatches;
+                }
+            }
+        };
+        compare();
+
+        std::vector<std::string> removed;
+        for (std::size_t i = 0; i < docPaths.size(); i += 7) {
+            index->removeFile(docPaths[i]);
+            segmented.removeFile(docPaths[i]);
+            removed.push_back(docPaths[i]);
+        }
+        for (std::size_t i = 3; i < docPaths.size(); i += 11) {
+            index->reindexFile(docPaths[i]);
+            segmented.reindexFile(docPaths[i]);
+        }
+        compare();
+        segmented.waitForMerges();
+        compare();
+
+        // Повертаємо спільний індекс у початковий стан для наступних бенчмарків.
+        for (const std::string& path : removed) {
+            index->addFile(path);
+        }
+
+        if (mismatches > 0) {
+            std::cerr << "segment check failed: mismatches " << mismatches << "\n";
+            failed = true;
+        }
+        r.extra.push_back({"segments", static_cast<double>(segmented.segmentCount())});
+        r.extra.push_back({"merges", static_cast<double>(merges.value() - mergesBefore)});
+        r.extra.push_back({"posting_bytes", static_cast<double>(segmented.postingMemoryUsage())});
+        r.extra.push_back({"mismatches", static_cast<double>(mismatches)});
+    }
+
+    void ensureIndex() {
+        if (index) {
+            return;
+        }
+        index = std::make_unique<IndexManager>();
+        index->setThreadPool(&pool);
+        index->addFiles(docPaths, pool);
+        index->waitForMerges();
+    }
+
+    void benchQueries(BenchResult& r, std::size_t wordsPerQuery, bool matchAll) {
+        ensureIndex();
+
+        CorpusGenerator generator(opt.corpus);
+        std::vector<std::vector<std::string>> queries;
+        queries.reserve(opt.queries);
+        for (std::size_t i = 0; i < opt.queries; ++i) {
+            queries.push_back(generator.nextQuery(wordsPerQuery));
+        }
+
+        runQueries(r, *index, pool, queries, matchAll);
+    }
+
+    void runQueries(BenchResult& r,
+                    const IndexManager& target,
+                    ThreadPool& queryPool,
+                    const std::vector<std::vector<std::string>>& queries,
+                    bool matchAll) {
+        metrics::LatencyHistogram hist;
+        std::atomic<std::size_t> totalResults(0);
+        auto start = std::chrono::steady_clock::now();
+        queryPool.parallelFor(0, queries.size(), [&](std::size_t lo, std::size_t hi) {
+            std::vector<std::string> paths;
+            for (std::size_t i = lo; i < hi; ++i) {
+                std::uint64_t t0 = metrics::nowNanos();
+                if (queries[i].size() == 1) {
+                    target.searchSingleWord(queries[i].front(), paths);
+                } else if (matchAll) {
+                    target.searchAllWords(queries[i], paths);
+                } else {
+                    target.searchAnyWord(queries[i], paths);
+                }
+                hist.record(metrics::nowNanos() - t0);
+                totalResults.fetch_add(paths.size(), std::memory_order_relaxed);
+            }
+        }, 16);
+        r.seconds    = elapsedSeconds(start);
+        r.operations = queries.size();
+        r.hasLatency = true;
+        r.latency    = hist.snapshot();
+        r.extra.push_back({"avg_results", static_cast<double>(totalResults.load()) / static_cast<double>(queries.size())});
+    }
+
+    std::vector<std::string> makeSocketRequests() const {
+        CorpusGenerator generator(opt.corpus);
+        std::vector<std::string> requests;
+        for (std::size_t i = 0; i < opt.socketQueries; ++i) {
+            std::string request = "SEARCH_ANY";
+            for (const std::string& word : generator.nextQuery(opt.wordsPerQuery)) {
+                request += " " + word;
+            }
+            request += " LIMIT 100";
+            requests.push_back(request);
+        }
+        return requests;
+    }
+
+    // opt.clients потоків ганяють requests на порт, поки список не вичерпається.
+    void runSocketLoad(int port, const std::vector<std::string>& requests, BenchResult& r) {
+        metrics::LatencyHistogram hist;
+        std::atomic<std::size_t> nextRequest(0);
+        std::atomic<std::size_t> failures(0);
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> clients;
+        for (std::size_t c = 0; c < opt.clients; ++c) {
+            clients.emplace_back([&]() {
+                TcpClient client("127.0.0.1", port);
+                client.setTimeout(10000);
+                std::string response;
+                std::string error;
+                for (;;) {
+                    std::size_t i = nextRequest.fetch_add(1);
+                    if (i >= requests.size()) {
+                        return;
+                    }
+                    std::uint64_t t0 = metrics::nowNanos();
+                    bool ok = client.request(requests[i], response, error);
+                    hist.record(metrics::nowNanos() - t0);
+                    if (!ok || response.compare(0, 2, "OK") != 0) {
+                        failures.fetch_add(1);
+                    }
+                }
+            });
+        }
+        for (std::thread& t : clients) {
+            t.join();
+        }
+        r.seconds    = elapsedSeconds(start);
+        r.operations = requests.size();
+        r.hasLatency = true;
+        r.latency    = hist.snapshot();
+        r.extra.push_back({"failures", static_cast<double>(failures.load())});
+    }
+
+    void benchSocket(BenchResult& r) {
+        Server server(opt.threads);
+        if (!Server::initSockets() || !server.initServer("127.0.0.1", 0)) {
+            std::cerr << "Cannot start server for socket benchmark\n";
+            failed = true;
+            return;
+        }
+        server.getIndexManager().addFiles(docPaths, server.getThreadPool());
+        std::thread acceptThread([&server]() { server.acceptLoop(); });
+
+        runSocketLoad(server.boundPort(), makeSocketRequests(), r);
+
+        server.stop();
+        acceptThread.join();
+    }
+
+    // Сервер з малим пулом і обмеженням прийнятих з'єднань під навантаженням
+    // у кілька разів більшим, ніж він встигає обробити. Кожна відповідь має бути
+    // або повним результатом, або швидкою відмовою ERROR BUSY / ERROR TIMEOUT.
+    // Перед цим - детерміновані перевірки обох механізмів.
+    void benchOverload(BenchResult& r) {
+        ensureIndex();
+
+        // Прострочений термін: пошук не повертає нічого.
+        std::vector<unsigned int> docIds;
+        Deadline past(Deadline::Clock::now());
+        std::vector<std::string> frequent = {CorpusGenerator::wordForRank(0), CorpusGenerator::wordForRank(1)};
+        bool deadlineOk = !index->findAnyWord(frequent, docIds, past) && docIds.empty()
+                       && index->findAnyWord(frequent, docIds);
+
+        const int kTimeoutMs = 200;
+        Server server(1);
+        server.setAdmissionLimits(1, kTimeoutMs);
+        if (!Server::initSockets() || !server.initServer("127.0.0.1", 0)) {
+            std::cerr << "Cannot start server for overload benchmark\n";
+            failed = true;
+            return;
+        }
+        server.getIndexManager().addFiles(docPaths, server.getThreadPool());
+        std::thread acceptThread([&server]() { server.acceptLoop(); });
+        int port = server.boundPort();
+
+        // Мовчазне з'єднання займає єдине місце - наступне має отримати ERROR BUSY;
+        // через термін запиту сервер закриває мовчазне з'єднання і місце звільняється.
+        TcpClient client("127.0.0.1", port);
+        client.setTimeout(5000);
+        std::string response;
+        std::string error;
+        bool busyOk = false;
+        SocketHandle idle = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr;
+        addr.sin_family      = AF_INET;
+        addr.sin_port        = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+        if (idle != INVALID_SOCKET && ::connect(idle, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            busyOk = client.request("SEARCH_ONE " + frequent.front(), response, error)
+                  && response == "ERROR BUSY\n";
+        }
+        if (idle != INVALID_SOCKET) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(kTimeoutMs * 2));
+            closeSocketHandle(idle);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        bool admittedOk = client.request("SEARCH_ONE " + frequent.front(), response, error)
+                       && response.compare(0, 2, "OK") == 0;
+
+        server.setAdmissionLimits(4, kTimeoutMs);
+        std::vector<std::string> requests = makeSocketRequests();
+        std::atomic<std::size_t> nextRequest(0);
+        std::atomic<std::size_t> answered(0);
+        std::atomic<std::size_t> busy(0);
+        std::atomic<std::size_t> timedOut(0);
+        std::atomic<std::size_t> broken(0);
+        metrics::LatencyHistogram hist;
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> clients;
+        for (std::size_t c = 0; c < opt.clients * 4; ++c) {
+            clients.emplace_back([&]() {
+                TcpClient loadClient("127.0.0.1", port);
+                loadClient.setTimeout(10000);
+                std::string body;
+                std::string err;
+                for (;;) {
+                    std::size_t i = nextRequest.fetch_add(1);
+                    if (i >= requests.size()) {
+                        return;
+                    }
+                    std::uint64_t t0 = metrics::nowNanos();
+                    bool ok = loadClient.request(requests[i], body, err);
+                    hist.record(metrics::nowNanos() - t0);
+                    if (ok && body == "ERROR BUSY\n") {
+                        busy.fetch_add(1);
+                    } else if (ok && body == "ERROR TIMEOUT\n") {
+                        timedOut.fetch_add(1);
+                    } else if (ok && body.compare(0, 2, "OK") == 0
+                               && body.size() >= 4 && body.compare(body.size() - 4, 4, "END\n") == 0) {
+                        answered.fetch_add(1);
+                    } else {
+                        broken.fetch_add(1);
+                    }
+                }
+            });
+        }
+        for (std::thread& t : clients) {
+            t.join();
+        }
+        r.seconds    = elapsedSeconds(start);
+        r.operations = requests.size();
+        r.hasLatency = true;
+        r.latency    = hist.snapshot();
+
+        server.stop();
+        acceptThread.join();
+
+        if (!deadlineOk || !busyOk || !admittedOk || broken.load() > 0) {
+            std::cerr << "overload check failed: deadline " << deadlineOk << ", busy " << busyOk
+                      << ", admitted " << admittedOk << ", broken " << broken.load() << "\n";
+            failed = true;
+        }
+        r.extra.push_back({"answered", static_cast<double>(answered.load())});
+        r.extra.push_back({"busy", static_cast<double>(busy.load())});
+        r.extra.push_back({"timed_out", static_cast<double>(timedOut.load())});
+        r.extra.push_back({"broken", static_cast<double>(broken.load())});
+    }
+
+    // Шляхи з відповіді "OK n ...\n<шлях>\n...END\n".
+    static std::vector<std::string> responsePaths(const std::string& response) {
+        std::vector<std::string> paths;
+        std::istringstream lines(response);
+        std::string line;
+        std::getline(lines, line);
+        while (std::getline(lines, line) && line != "END") {
+            paths.push_back(line);
+        }
+        return paths;
+    }
+
+    // Координатор + opt.shards шардів у цьому процесі, кожен на своєму порту.
+    // Спершу перевіряє, що злиті результати збігаються з одновузловим індексом
+    // і що зупинений шард дає частковий результат, потім міряє навантаження.
+    void benchCluster(BenchResult& r) {
+        ensureIndex();
+        if (!Server::initSockets()) {
+            failed = true;
+            return;
+        }
+
+        std::vector<std::unique_ptr<Server>> shardServers;
+        std::vector<std::thread>             shardThreads;
+        std::vector<ShardEndpoint>           endpoints;
+        auto stopShards = [&]() {
+            for (std::size_t i = 0; i < shardThreads.size(); ++i) {
+                shardServers[i]->stop();
+                shardThreads[i].join();
+            }
+            shardThreads.clear();
+        };
+
+        unsigned int shardThreadCount = std::max(1u, opt.threads / static_cast<unsigned int>(opt.shards));
+        for (std::size_t i = 0; i < opt.shards; ++i) {
+            shardServers.push_back(std::make_unique<Server>(shardThreadCount));
+            Server& shard = *shardServers.back();
+            if (!shard.initServer("127.0.0.1", 0)) {
+                stopShards();
+                failed = true;
+                return;
+            }
+            ShardEndpoint endpoint;
+            endpoint.ip   = "127.0.0.1";
+            endpoint.port = shard.boundPort();
+            endpoints.push_back(endpoint);
+            shardThreads.emplace_back([&shard]() { shard.acceptLoop(); });
+        }
+
+        Server front(opt.threads);
+        ShardCoordinator coordinator(endpoints, front.getThreadPool(), 2000);
+        front.setCoordinator(&coordinator);
+        if (!front.initServer("127.0.0.1", 0)) {
+            stopShards();
+            failed = true;
+            return;
+        }
+        std::thread frontThread([&front]() { front.acceptLoop(); });
+        int port = front.boundPort();
+
+        unsigned int added = coordinator.addFiles(docPaths);
+
+        // Перевірка: той самий запит на кластер і на один IndexManager.
+        std::vector<std::string> requests = makeSocketRequests();
+        std::size_t mismatches = 0;
+        std::size_t checks = std::min<std::size_t>(requests.size(), 50);
+        TcpClient client("127.0.0.1", port);
+        client.setTimeout(10000);
+        std::string response;
+        std::string error;
+        for (std::size_t i = 0; i < checks; ++i) {
+            std::istringstream words(requests[i]);
+            std::vector<std::string> args;
+            std::string word;
+            words >> word;
+            while (words >> word && word != "LIMIT") {
+                args.push_back(word);
+            }
+            ResultWindow window;
+            window.limit = 100;
+            std::vector<std::string> expected;
+            index->searchAnyWord(args, expected, window);
+
+            if (!client.request(requests[i], response, error) || responsePaths(response) != expected) {
+                ++mismatches;
+            }
+        }
+
+        runSocketLoad(port, requests, r);
+
+        // Зупинений шард: координатор має відповісти частковим результатом.
+        shardServers.back()->stop();
+        shardThreads.back().join();
+        shardThreads.pop_back();
+        bool partialOk = client.request(requests.front(), response, error)
+                      && response.compare(0, 2, "OK") == 0
+                      && response.find(" PARTIAL 1/") < response.find('\n');
+
+        front.stop();
+        frontThread.join();
+        stopShards();
+
+        if (added != docPaths.size() || mismatches > 0 || !partialOk) {
+            std::cerr << "cluster check failed: added " << added << "/" << docPaths.size()
+                      << ", mismatches " << mismatches << ", partial " << partialOk << "\n";
+            failed = true;
+        }
+        r.extra.push_back({"shards", static_cast<double>(opt.shards)});
+        r.extra.push_back({"mismatches", static_cast<double>(mismatches)});
+    }
+
+    // Лідер на сокеті, фоловер A під'єднаний до індексації (отримує журнал),
+    // фоловер B - після змін (отримує знімок). Час - від початку індексації
+    // на лідері до моменту, коли A застосував останній запис.
+    void benchReplication(BenchResult& r) {
+        if (!Server::initSockets()) {
+            failed = true;
+            return;
+        }
+
+        MutationLog log;
+        Server leaderServer(opt.threads);
+        leaderServer.getIndexManager().setMutationLog(&log);
+        replication::Leader leader(leaderServer.getIndexManager(), log);
+        leaderServer.setReplicationLeader(&leader);
+        if (!leaderServer.initServer("127.0.0.1", 0)) {
+            failed = true;
+            return;
+        }
+        std::thread acceptThread([&leaderServer]() { leaderServer.acceptLoop(); });
+        int port = leaderServer.boundPort();
+
+        IndexManager replicaA;
+        replication::Follower followerA(replicaA, "127.0.0.1", port);
+        followerA.start();
+
+        auto start = std::chrono::steady_clock::now();
+        leaderServer.getIndexManager().addFiles(docPaths, pool);
+        bool caughtUp = followerA.waitForSeq(log.lastSeq(), 30000);
+        r.seconds    = elapsedSeconds(start);
+        r.operations = log.lastSeq();
+
+        // Видалення й переіндексація теж мають дійти до реплік.
+        IndexManager& primary = leaderServer.getIndexManager();
+        for (std::size_t i = 0; i < docPaths.size(); i += 7) {
+            primary.removeFile(docPaths[i]);
+        }
+        for (std::size_t i = 3; i < docPaths.size(); i += 11) {
+            primary.reindexFile(docPaths[i]);
+        }
+
+        IndexManager replicaB;
+        replication::Follower followerB(replicaB, "127.0.0.1", port);
+        followerB.start();
+
+        std::uint64_t target = log.lastSeq();
+        caughtUp = followerA.waitForSeq(target, 30000) && followerB.waitForSeq(target, 30000) && caughtUp;
+
+        CorpusGenerator generator(opt.corpus);
+        std::size_t mismatches = 0;
+        for (std::size_t i = 0; i < 50; ++i) {
+            std::vector<std::string> query = generator.nextQuery(opt.wordsPerQuery);
+            std::vector<std::string> expected;
+            std::vector<std::string> actualA;
+            std::vector<std::string> actualB;
+            primary.searchAnyWord(query, expected);
+            replicaA.searchAnyWord(query, actualA);
+            replicaB.searchAnyWord(query, actualB);
+            if (actualA != expected || actualB != expected) {
+                ++mismatches;
+            }
+        }
+        if (replicaA.documentCount() != primary.documentCount()
+            || replicaB.documentCount() != primary.documentCount()) {
+            ++mismatches;
+        }
+
+        followerA.stop();
+        followerB.stop();
+        leader.stop();
+        leaderServer.stop();
+        acceptThread.join();
+
+        if (!caughtUp || mismatches > 0) {
+            std::cerr << "replication check failed: caught up " << caughtUp
+                      << ", mismatches " << mismatches << "\n";
+            failed = true;
+        }
+        r.extra.push_back({"log_records", static_cast<double>(target)});
+        r.extra.push_back({"mismatches", static_cast<double>(mismatches)});
+    }
+
+    // Те саме навантаження, що query_any, але пул закріплено за NUMA-вузлами,
+    // а пошук читає копію індексу свого вузла. На одному вузлі це звичайний пул
+    // (порівнювати з query_any); --numa-emulate перевіряє сам механізм.
+    void benchNuma(BenchResult& r) {
+        ensureIndex();
+        NumaTopology topology = opt.numaEmulate > 0 ? NumaTopology::emulated(opt.numaEmulate)
+                                                    : NumaTopology::system();
+
+        ThreadPool pinnedPool(opt.threads, WorkerPinning::Node, topology);
+        IndexManager local;
+        local.setThreadPool(&pinnedPool);
+        local.enableNodeReplicas(topology);
+        local.addFiles(docPaths, pinnedPool);
+        bool fresh = local.waitForNodeReplicas(30000);
+
+        CorpusGenerator generator(opt.corpus);
+        std::vector<std::vector<std::string>> queries;
+        queries.reserve(opt.queries);
+        for (std::size_t i = 0; i < opt.queries; ++i) {
+            queries.push_back(generator.nextQuery(opt.wordsPerQuery));
+        }
+        metrics::Counter& localReads = metrics::registry().counter(
+            "cw_numa_replica_reads_total", "Reads by replica freshness", "result=\"local\"");
+        std::uint64_t localBefore = localReads.value();
+        runQueries(r, local, pinnedPool, queries, false);
+        std::uint64_t localAfter = localReads.value();
+
+        // Копії мають давати ті самі результати, а одразу після зміни - не бути застарілими.
+        std::size_t mismatches = 0;
+        auto compare = [&]() {
+            for (std::size_t i = 0; i < 50 && i < queries.size(); ++i) {
+                std::vector<std::string> expected;
+                std::vector<std::string> actual;
+                index->searchAnyWord(queries[i], expected);
+                local.searchAnyWord(queries[i], actual);
+                if (actual != expected) {
+                    ++mismatches;
+                }
+            }
+        };
+        compare();
+        if (!docPaths.empty()) {
+            index->removeFile(docPaths.front());
+            local.removeFile(docPaths.front());
+            compare();
+            index->addFile(docPaths.front());
+            local.addFile(docPaths.front());
+        }
+
+        if (!fresh || mismatches > 0) {
+            std::cerr << "numa check failed: replicas fresh " << fresh
+                      << ", mismatches " << mismatches << "\n";
+            failed = true;
+        }
+        r.extra.push_back({"numa_nodes", static_cast<double>(topology.nodeCount())});
+        r.extra.push_back({"replica_reads", static_cast<double>(localAfter - localBefore)});
+        r.extra.push_back({"mismatches", static_cast<double>(mismatches)});
+    }
+
+private:
+    const BenchOptions&           opt;
+    ThreadPool&                   pool;
+    std::vector<std::string>      docs;
+    std::vector<PostingList>      rankPostings;
+    std::string                   corpusDir;
+    std::vector<std::string>      docPaths;
+    std::unique_ptr<IndexManager> index;
+    bool                          failed;
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchOptions opt;
+    if (!parseOptions(argc, argv, opt)) {
+        return 2;
+    }
+
+    ThreadPool pool(opt.threads);
+    std::vector<BenchResult> results;
+    BenchSuite suite(opt, pool);
+    suite.run(results);
+
+    std::string json = renderJson(opt, pool.size(), results);
+    if (opt.outPath.empty()) {
+        std::cout << json;
+    } else {
+        std::ofstream out(opt.outPath);
+        if (!out) {
+            std::cerr << "Cannot write " << opt.outPath << "\n";
+            return 1;
+        }
+        out << json;
+    }
+
+    Server::cleanupSockets();
+    return suite.passed() ? 0 : 1;
+}
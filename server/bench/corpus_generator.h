@@ -0,0 +1,131 @@
+#ifndef CORPUS_GENERATOR_H
+#define CORPUS_GENERATOR_H
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Синтетичний корпус із розподілом слів за законом Ципфа:
+// слово рангу r зустрічається з імовірністю ~ 1 / r^s.
+// Однаковий seed дає однаковий корпус на будь-якій машині.
+
+struct CorpusConfig {
+    std::size_t   documents    = 10000;
+    std::size_t   vocabulary   = 50000;
+    std::size_t   wordsPerDoc  = 200;
+    double        zipfExponent = 1.0;
+    std::uint64_t seed         = 42;
+};
+
+class ZipfSampler {
+public:
+    ZipfSampler(std::size_t n, double s) {
+        cdf.resize(n);
+        double total = 0.0;
+        for (std::size_t r = 0; r < n; ++r) {
+            total += 1.0 / std::pow(static_cast<double>(r + 1), s);
+            cdf[r] = total;
+        }
+        for (double& v : cdf) {
+            v /= total;
+        }
+    }
+
+    // Ранг у [0, n). std::uniform_real_distribution не однаковий у різних
+    // стандартних бібліотеках, тому число в [0, 1) береться прямо з бітів генератора.
+    std::size_t operator()(std::mt19937_64& rng) const {
+        double u = static_cast<double>(rng() >> 11) * (1.0 / 9007199254740992.0);
+        auto it = std::lower_bound(cdf.begin(), cdf.end(), u);
+        if (it == cdf.end()) {
+            return cdf.size() - 1;
+        }
+        return static_cast<std::size_t>(it - cdf.begin());
+    }
+
+private:
+    std::vector<double> cdf;
+};
+
+class CorpusGenerator {
+public:
+    explicit CorpusGenerator(const CorpusConfig& config)
+        : config(config)
+        , sampler(config.vocabulary, config.zipfExponent)
+        , rng(config.seed)
+    {}
+
+    // Слово за рангом: лише ASCII-літери, тому токенізатор не ріже його.
+    static std::string wordForRank(std::size_t rank) {
+        std::string word = "w";
+        do {
+            word.push_back(static_cast<char>('a' + rank % 26));
+            rank /= 26;
+        } while (rank != 0);
+        return word;
+    }
+
+    std::size_t sampleRank() {
+        return sampler(rng);
+    }
+
+    std::string nextDocument() {
+        std::string text;
+        text.reserve(config.wordsPerDoc * 8);
+        for (std::size_t i = 0; i < config.wordsPerDoc; ++i) {
+            if (i != 0) {
+                text.push_back(i % 12 == 0 ? '\n' : ' ');
+            }
+            text += wordForRank(sampleRank());
+        }
+        return text;
+    }
+
+    std::vector<std::string> generateDocuments() {
+        std::vector<std::string> docs;
+        docs.reserve(config.documents);
+        for (std::size_t i = 0; i < config.documents; ++i) {
+            docs.push_back(nextDocument());
+        }
+        return docs;
+    }
+
+    // Записує документи у dir/doc_<i>.txt і повертає шляхи.
+    static bool writeDocuments(const std::vector<std::string>& docs,
+                               const std::string& dir,
+                               std::vector<std::string>& outPaths) {
+        outPaths.clear();
+        outPaths.reserve(docs.size());
+        for (std::size_t i = 0; i < docs.size(); ++i) {
+            std::string path = dir + "/doc_" + std::to_string(i) + ".txt";
+            std::ofstream out(path, std::ios::binary);
+            if (!out) {
+                return false;
+            }
+            out << docs[i];
+            outPaths.push_back(path);
+        }
+        return true;
+    }
+
+    // Запит із n слів, ранги яких вибрані за тим самим розподілом.
+    std::vector<std::string> nextQuery(std::size_t n) {
+        std::vector<std::string> words;
+        words.reserve(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            words.push_back(wordForRank(sampleRank()));
+        }
+        return words;
+    }
+
+private:
+    CorpusConfig     config;
+    ZipfSampler      sampler;
+    std::mt19937_64  rng;
+};
+
+#endif
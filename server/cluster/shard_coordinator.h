@@ -0,0 +1,351 @@
+#ifndef SHARD_COORDINATOR_H
+#define SHARD_COORDINATOR_H
+
+#include <string>
+#include <vector>
+#include <queue>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+
+#include "index_manager.h"
+#include "thread_pool.h"
+#include "tcp_client.h"
+#include "metrics.h"
+#include "deadline.h"
+
+// Координатор документно-розбитого кластера.
+//   - кожен документ належить рівно одному шарду: FNV-1a(шлях) % N;
+//   - ADD_FILE / REMOVE_FILE / REINDEX_FILE / HAS_FILE пересилаються шарду-власнику;
+//   - пошукові запити розсилаються всім шардам паралельно (scatter-gather),
+//     відсортовані відповіді зливаються k-шляховим злиттям;
+//   - шард, що не відповів за timeoutMs, пропускається: результат позначається частковим;
+//   - очікування шарду не довше, ніж лишилось до терміну запиту клієнта.
+// Шарди - звичайні процеси сервера зі своїм IndexManager. Кількість шардів
+// фіксована: при зміні N документи треба переіндексувати.
+
+struct ShardEndpoint {
+    std::string ip;
+    int         port = 0;
+};
+
+class ShardCoordinator {
+public:
+    struct SearchResult {
+        std::vector<std::string> paths;
+        std::size_t              failedShards = 0;
+        std::string              error;     // непорожній, якщо не відповів жоден шард
+    };
+
+    ShardCoordinator(const std::vector<ShardEndpoint>& endpoints, ThreadPool& pool, int timeoutMs)
+        : pool(pool)
+        , timeoutMs(timeoutMs)
+        , partialResponses(metrics::registry().counter("cw_coordinator_partial_responses_total",
+                                                       "Search responses missing at least one shard"))
+    {
+        shards.reserve(endpoints.size());
+        for (std::size_t i = 0; i < endpoints.size(); ++i) {
+            shards.push_back(Shard(endpoints[i], i));
+        }
+    }
+
+    ShardCoordinator(const ShardCoordinator&)            = delete;
+    ShardCoordinator& operator=(const ShardCoordinator&) = delete;
+    ShardCoordinator(ShardCoordinator&&)                 = delete;
+    ShardCoordinator& operator=(ShardCoordinator&&)      = delete;
+
+    // "host:port,host:port,..."
+    static bool parseEndpoints(const std::string& list,
+                               std::vector<ShardEndpoint>& outEndpoints,
+                               std::string& outError) {
+        outEndpoints.clear();
+        std::size_t pos = 0;
+        while (pos <= list.size()) {
+            std::size_t comma = list.find(',', pos);
+            if (comma == std::string::npos) {
+                comma = list.size();
+            }
+            std::string item = list.substr(pos, comma - pos);
+            std::size_t colon = item.rfind(':');
+            if (colon == std::string::npos || colon == 0 || colon + 1 == item.size()
+                || item.find_first_not_of("0123456789", colon + 1) != std::string::npos) {
+                outError = "Invalid shard address '" + item + "', expected host:port";
+                return false;
+            }
+            ShardEndpoint endpoint;
+            endpoint.ip   = item.substr(0, colon);
+            endpoint.port = std::atoi(item.c_str() + colon + 1);
+            outEndpoints.push_back(endpoint);
+            pos = comma + 1;
+        }
+        if (outEndpoints.empty()) {
+            outError = "No shards given";
+            return false;
+        }
+        return true;
+    }
+
+    std::size_t shardCount() const {
+        return shards.size();
+    }
+
+    // Стабільний між процесами хеш (std::hash таким не є).
+    std::size_t shardFor(const std::string& docPath) const {
+        std::uint64_t hash = 14695981039346656037ull;
+        for (unsigned char ch : docPath) {
+            hash ^= ch;
+            hash *= 1099511628211ull;
+        }
+        return static_cast<std::size_t>(hash % shards.size());
+    }
+
+    // Пересилає запит про один документ його шарду; відповідь шарду - як є.
+    bool forward(const std::string& docPath,
+                 const std::string& request,
+                 std::string& outResponse,
+                 std::string& outError,
+                 const Deadline& deadline = Deadline()) const {
+        const Shard& shard = shards[shardFor(docPath)];
+        if (!call(shard, request, outResponse, outError, deadline)) {
+            outError = "Shard " + std::to_string(shard.index) + " unavailable: " + outError;
+            return false;
+        }
+        return true;
+    }
+
+    // Розподіляє файли між шардами (ADD_FILE паралельно). Повертає кількість доданих.
+    unsigned int addFiles(const std::vector<std::string>& docPaths) const {
+        std::atomic<unsigned int> added(0);
+        pool.parallelFor(0, docPaths.size(), [&](std::size_t lo, std::size_t hi) {
+            std::string response;
+            std::string error;
+            for (std::size_t i = lo; i < hi; ++i) {
+                if (forward(docPaths[i], "ADD_FILE " + docPaths[i], response, error)
+                    && response.compare(0, 2, "OK") == 0) {
+                    added.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }, 1);
+        return added.load();
+    }
+
+    // Scatter-gather пошук. request - команда з аргументами без LIMIT/OFFSET/ORDER:
+    // вікно застосовується тут, а шардам іде лише LIMIT offset+limit (top-k з кожного).
+    bool search(const std::string& request,
+                const ResultWindow& window,
+                SearchResult& out,
+                const Deadline& deadline = Deadline()) const {
+        out = SearchResult();
+
+        std::string shardRequest = request;
+        if (window.limit != static_cast<std::size_t>(-1)) {
+            std::size_t topK = window.offset + window.limit;
+            if (topK >= window.offset) {
+                shardRequest += " LIMIT " + std::to_string(topK);
+            }
+        }
+        shardRequest += window.order == ResultOrder::ByDocId ? " ORDER DOCID" : " ORDER PATH";
+
+        std::vector<std::vector<std::string>> perShard(shards.size());
+        std::vector<std::string>              errors(shards.size());
+        std::vector<ShardState>               states(shards.size(), ShardState::Unreachable);
+
+        pool.parallelFor(0, shards.size(), [&](std::size_t lo, std::size_t hi) {
+            std::string response;
+            for (std::size_t i = lo; i < hi; ++i) {
+                if (!call(shards[i], shardRequest, response, errors[i], deadline)) {
+                    continue;
+                }
+                states[i] = parseSearchResponse(response, perShard[i], errors[i])
+                          ? ShardState::Answered
+                          : ShardState::Rejected;
+            }
+        }, 1);
+
+        std::vector<const std::vector<std::string>*> lists;
+        for (std::size_t i = 0; i < shards.size(); ++i) {
+            if (states[i] == ShardState::Answered) {
+                lists.push_back(&perShard[i]);
+            } else {
+                ++out.failedShards;
+            }
+        }
+
+        if (lists.empty()) {
+            // Помилка, яку повернув сам шард (наприклад, синтаксис QUERY), важливіша
+            // за мережеву: її клієнт і отримає.
+            out.error = "All shards unavailable";
+            for (std::size_t i = 0; i < shards.size(); ++i) {
+                if (states[i] == ShardState::Rejected) {
+                    out.error = errors[i];
+                    break;
+                }
+            }
+            return false;
+        }
+        if (out.failedShards > 0) {
+            partialResponses.add();
+        }
+
+        if (window.order == ResultOrder::ByDocId) {
+            // docId локальні для шарду, глобального порядку немає: шарди по черзі.
+            collectConcatenated(lists, window, out.paths);
+        } else {
+            mergeByPath(lists, window, out.paths);
+        }
+        return true;
+    }
+
+    // "OK n\n<шлях>\n...END\n" -> шляхи; ERROR або обрізана відповідь -> false.
+    static bool parseSearchResponse(const std::string& response,
+                                    std::vector<std::string>& outPaths,
+                                    std::string& outError) {
+        outPaths.clear();
+        std::size_t eol = response.find('\n');
+        if (eol == std::string::npos) {
+            outError = "Truncated shard response";
+            return false;
+        }
+        std::string header = response.substr(0, eol);
+        if (header.compare(0, 6, "ERROR ") == 0) {
+            outError = header.substr(6);
+            return false;
+        }
+        if (header.compare(0, 3, "OK ") != 0) {
+            outError = "Unexpected shard response";
+            return false;
+        }
+
+        std::size_t count = std::strtoull(header.c_str() + 3, nullptr, 10);
+        outPaths.reserve(count);
+        std::size_t pos = eol + 1;
+        while (pos < response.size()) {
+            eol = response.find('\n', pos);
+            if (eol == std::string::npos) {
+                break;
+            }
+            if (response.compare(pos, eol - pos, "END") == 0) {
+                return true;
+            }
+            outPaths.emplace_back(response, pos, eol - pos);
+            pos = eol + 1;
+        }
+        outError = "Truncated shard response";
+        return false;
+    }
+
+    // k-шляхове злиття відсортованих за шляхом списків до offset + limit елементів.
+    static void mergeByPath(const std::vector<const std::vector<std::string>*>& lists,
+                            const ResultWindow& window,
+                            std::vector<std::string>& outPaths) {
+        typedef std::pair<std::size_t, std::size_t> Cursor; // (список, позиція)
+        auto greater = [&lists](const Cursor& lhs, const Cursor& rhs) {
+            return (*lists[rhs.first])[rhs.second] < (*lists[lhs.first])[lhs.second];
+        };
+        std::priority_queue<Cursor, std::vector<Cursor>, decltype(greater)> heap(greater);
+        for (std::size_t i = 0; i < lists.size(); ++i) {
+            if (!lists[i]->empty()) {
+                heap.push(Cursor(i, 0));
+            }
+        }
+
+        std::size_t end = windowEnd(window);
+        for (std::size_t rank = 0; rank < end && !heap.empty(); ++rank) {
+            Cursor top = heap.top();
+            heap.pop();
+            if (rank >= window.offset) {
+                outPaths.push_back((*lists[top.first])[top.second]);
+            }
+            if (top.second + 1 < lists[top.first]->size()) {
+                heap.push(Cursor(top.first, top.second + 1));
+            }
+        }
+    }
+
+    // Порядок docId: списки шардів по черзі, вікно - за наскрізним рангом.
+    static void collectConcatenated(const std::vector<const std::vector<std::string>*>& lists,
+                                    const ResultWindow& window,
+                                    std::vector<std::string>& outPaths) {
+        std::size_t end  = windowEnd(window);
+        std::size_t rank = 0;
+        for (const std::vector<std::string>* list : lists) {
+            for (const std::string& path : *list) {
+                if (rank >= end) {
+                    return;
+                }
+                if (rank >= window.offset) {
+                    outPaths.push_back(path);
+                }
+                ++rank;
+            }
+        }
+    }
+
+private:
+    enum class ShardState {
+        Unreachable,
+        Rejected,
+        Answered
+    };
+
+    struct Shard {
+        Shard(const ShardEndpoint& endpoint, std::size_t index)
+            : endpoint(endpoint)
+            , index(index)
+            , ok(&counterFor(index, "ok"))
+            , error(&counterFor(index, "error"))
+            , latency(&metrics::registry().histogram("cw_shard_request_duration_seconds",
+                                                     "Coordinator to shard round trip",
+                                                     "shard=\"" + std::to_string(index) + "\""))
+        {}
+
+        static metrics::Counter& counterFor(std::size_t index, const char* status) {
+            return metrics::registry().counter("cw_shard_requests_total", "Requests sent to shards",
+                                               "shard=\"" + std::to_string(index) + "\",status=\""
+                                               + status + "\"");
+        }
+
+        ShardEndpoint              endpoint;
+        std::size_t                index;
+        metrics::Counter*          ok;
+        metrics::Counter*          error;
+        metrics::LatencyHistogram* latency;
+    };
+
+    bool call(const Shard& shard, const std::string& request,
+              std::string& outResponse, std::string& outError,
+              const Deadline& deadline) const {
+        // Тайм-аут шарду, але не більше залишку терміну запиту.
+        int budgetMs = timeoutMs;
+        long long remaining = deadline.remainingMs();
+        if (remaining == 0) {
+            outError = "request deadline expired";
+            return false;
+        }
+        if (remaining > 0 && (budgetMs <= 0 || remaining < budgetMs)) {
+            budgetMs = static_cast<int>(remaining);
+        }
+
+        TcpClient client(shard.endpoint.ip, shard.endpoint.port);
+        client.setTimeout(budgetMs);
+
+        metrics::ScopedTimer timer(*shard.latency);
+        bool ok = client.request(request, outResponse, outError);
+        (ok ? shard.ok : shard.error)->add();
+        return ok;
+    }
+
+    static std::size_t windowEnd(const ResultWindow& window) {
+        std::size_t end = window.offset + window.limit;
+        return end < window.offset ? static_cast<std::size_t>(-1) : end;
+    }
+
+private:
+    std::vector<Shard> shards;
+    ThreadPool&        pool;
+    int                timeoutMs;
+    metrics::Counter&  partialResponses;
+};
+
+#endif
@@ -3,9 +3,12 @@
 
 #include <queue>
 #include <shared_mutex>
+#include <mutex>
 #include <utility>
 #include <cstddef>
 
+#include "metrics.h"
+
 template <typename T>
 class ConcurrentQueue {
 public:
@@ -21,22 +24,22 @@ public:
     ConcurrentQueue& operator=(ConcurrentQueue&&)      = delete;
 
     bool empty() const {
-        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto lock = readLock();
         return queue_.empty();
     }
 
     std::size_t size() const {
-        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto lock = readLock();
         return queue_.size();
     }
 
     void clear() {
-        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto lock = writeLock();
         queue_ = std::queue<T>();
     }
 
     bool try_pop(T& value) {
-        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto lock = writeLock();
         if (queue_.empty()) {
             return false;
         }
@@ -47,7 +50,7 @@ public:
     }
 
     bool try_pop() {
-        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto lock = writeLock();
         if (queue_.empty()) {
             return false;
         }
@@ -57,16 +60,29 @@ public:
     }
 
     void push(const T& value) {
-        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto lock = writeLock();
         queue_.push(value);
     }
 
     void push(T&& value) {
-        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto lock = writeLock();
         queue_.push(std::move(value));
     }
 
 private:
+    std::shared_lock<std::shared_mutex> readLock() const {
+        return metrics::lockShared(mutex_, lockMetrics());
+    }
+
+    std::unique_lock<std::shared_mutex> writeLock() const {
+        return metrics::lockExclusive(mutex_, lockMetrics());
+    }
+
+    static metrics::LockMetrics& lockMetrics() {
+        static metrics::LockMetrics& lm = metrics::lockMetricsFor("concurrent_queue");
+        return lm;
+    }
+
     mutable std::shared_mutex mutex_;
     std::queue<T>             queue_;
 };
@@ -0,0 +1,247 @@
+#ifndef DOC_PATH_TABLE_H
+#define DOC_PATH_TABLE_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+// Щільний масив docId -> шлях для читання без блокувань.
+//   - слоти згруповані у шматки по 4096, шматки ніколи не переміщуються;
+//   - читач тримає ReadGuard, поки користується отриманими вказівниками;
+//   - записи серіалізуються м'ютексом, а замінені рядки звільняються за епохами:
+//     читач реєструється в лічильнику поточної епохи, рядок, замінений в епоху e,
+//     звільняється, коли глобальна епоха дійде до e + 2. Епоха просувається, щойно
+//     вийшли читачі попередньої, тож потік читачів, що перекриваються, не
+//     затримує звільнення назавжди.
+
+class DocPathTable {
+public:
+    static constexpr unsigned int kChunkBits = 12;
+    static constexpr unsigned int kChunkSize = 1u << kChunkBits;
+
+    class ReadGuard {
+    public:
+        explicit ReadGuard(const DocPathTable& table)
+            : table(table)
+        {
+            // Повтор, якщо епоха змінилась між читанням і реєстрацією: інакше
+            // писач міг уже перевірити цей лічильник і просунути епоху далі.
+            for (;;) {
+                std::uint64_t epoch = table.epoch.load(std::memory_order_seq_cst);
+                slot = static_cast<unsigned int>(epoch & 1);
+                table.readers[slot].fetch_add(1, std::memory_order_seq_cst);
+                if (table.epoch.load(std::memory_order_seq_cst) == epoch) {
+                    break;
+                }
+                table.readers[slot].fetch_sub(1, std::memory_order_seq_cst);
+            }
+        }
+
+        ~ReadGuard() {
+            table.readers[slot].fetch_sub(1, std::memory_order_seq_cst);
+        }
+
+        ReadGuard(const ReadGuard&)            = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+        // nullptr, якщо документа немає. Вказівник дійсний, поки живе guard.
+        const std::string* get(unsigned int docId) const {
+            const Directory* dir = table.directory.load(std::memory_order_seq_cst);
+            std::size_t chunkIndex = docId >> kChunkBits;
+            if (dir == nullptr || chunkIndex >= dir->capacity) {
+                return nullptr;
+            }
+            const Chunk* chunk = dir->chunks[chunkIndex].load(std::memory_order_seq_cst);
+            if (chunk == nullptr) {
+                return nullptr;
+            }
+            return chunk->slots[docId & (kChunkSize - 1)].load(std::memory_order_seq_cst);
+        }
+
+    private:
+        const DocPathTable& table;
+        unsigned int        slot;
+    };
+
+    DocPathTable()
+        : directory(nullptr)
+        , epoch(0)
+    {
+        readers[0].store(0, std::memory_order_relaxed);
+        readers[1].store(0, std::memory_order_relaxed);
+    }
+
+    ~DocPathTable() {
+        Directory* dir = directory.load(std::memory_order_relaxed);
+        if (dir != nullptr) {
+            for (std::size_t i = 0; i < dir->capacity; ++i) {
+                Chunk* chunk = dir->chunks[i].load(std::memory_order_relaxed);
+                if (chunk == nullptr) {
+                    continue;
+                }
+                for (auto& slot : chunk->slots) {
+                    delete slot.load(std::memory_order_relaxed);
+                }
+                delete chunk;
+            }
+        }
+        for (const auto& entry : retired) {
+            delete entry.second;
+        }
+    }
+
+    DocPathTable(const DocPathTable&)            = delete;
+    DocPathTable& operator=(const DocPathTable&) = delete;
+    DocPathTable(DocPathTable&&)                 = delete;
+    DocPathTable& operator=(DocPathTable&&)      = delete;
+
+    void set(unsigned int docId, const std::string& path) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        std::atomic<const std::string*>& slot = slotFor(docId);
+        const std::string* old = slot.exchange(new std::string(path), std::memory_order_seq_cst);
+        retire(old);
+    }
+
+    bool remove(unsigned int docId) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        Directory* dir = directory.load(std::memory_order_relaxed);
+        std::size_t chunkIndex = docId >> kChunkBits;
+        if (dir == nullptr || chunkIndex >= dir->capacity) {
+            return false;
+        }
+        Chunk* chunk = dir->chunks[chunkIndex].load(std::memory_order_relaxed);
+        if (chunk == nullptr) {
+            return false;
+        }
+        const std::string* old = chunk->slots[docId & (kChunkSize - 1)].exchange(nullptr, std::memory_order_seq_cst);
+        retire(old);
+        return old != nullptr;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        Directory* dir = directory.load(std::memory_order_relaxed);
+        if (dir == nullptr) {
+            return;
+        }
+        for (std::size_t i = 0; i < dir->capacity; ++i) {
+            Chunk* chunk = dir->chunks[i].load(std::memory_order_relaxed);
+            if (chunk == nullptr) {
+                continue;
+            }
+            for (auto& slot : chunk->slots) {
+                const std::string* old = slot.exchange(nullptr, std::memory_order_seq_cst);
+                if (old != nullptr) {
+                    retired.emplace_back(epoch.load(std::memory_order_relaxed), old);
+                }
+            }
+        }
+        reclaim();
+    }
+
+    // Замінені рядки, які ще чекають звільнення (статистика й тести).
+    std::size_t retiredCount() const {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        return retired.size();
+    }
+
+private:
+    struct Chunk {
+        Chunk() {
+            for (auto& slot : slots) {
+                slot.store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        std::atomic<const std::string*> slots[kChunkSize];
+    };
+
+    struct Directory {
+        explicit Directory(std::size_t cap)
+            : capacity(cap)
+            , chunks(new std::atomic<Chunk*>[cap])
+        {
+            for (std::size_t i = 0; i < cap; ++i) {
+                chunks[i].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        std::size_t                          capacity;
+        std::unique_ptr<std::atomic<Chunk*>[]> chunks;
+    };
+
+    std::atomic<const std::string*>& slotFor(unsigned int docId) {
+        std::size_t chunkIndex = docId >> kChunkBits;
+        Directory* dir = directory.load(std::memory_order_relaxed);
+
+        if (dir == nullptr || chunkIndex >= dir->capacity) {
+            std::size_t capacity = dir == nullptr ? 16 : dir->capacity;
+            while (capacity <= chunkIndex) {
+                capacity *= 2;
+            }
+            // Старий каталог лишається живим: читачі могли його вже завантажити.
+            directories.push_back(std::make_unique<Directory>(capacity));
+            Directory* bigger = directories.back().get();
+            if (dir != nullptr) {
+                for (std::size_t i = 0; i < dir->capacity; ++i) {
+                    bigger->chunks[i].store(dir->chunks[i].load(std::memory_order_relaxed),
+                                            std::memory_order_relaxed);
+                }
+            }
+            directory.store(bigger, std::memory_order_seq_cst);
+            dir = bigger;
+        }
+
+        Chunk* chunk = dir->chunks[chunkIndex].load(std::memory_order_relaxed);
+        if (chunk == nullptr) {
+            chunk = new Chunk();
+            dir->chunks[chunkIndex].store(chunk, std::memory_order_seq_cst);
+        }
+        return chunk->slots[docId & (kChunkSize - 1)];
+    }
+
+    void retire(const std::string* old) {
+        if (old != nullptr) {
+            retired.emplace_back(epoch.load(std::memory_order_relaxed), old);
+        }
+        reclaim();
+    }
+
+    // Під writeMutex. Епоха e -> e + 1, коли вийшли всі читачі епохи e - 1
+    // (той самий лічильник, що й для e + 1); активні читачі тоді лише в e чи e + 1.
+    void reclaim() {
+        if (retired.empty()) {
+            return;
+        }
+        for (int step = 0; step < 2; ++step) {
+            std::uint64_t current = epoch.load(std::memory_order_relaxed);
+            if (readers[(current + 1) & 1].load(std::memory_order_seq_cst) != 0) {
+                break;
+            }
+            epoch.store(current + 1, std::memory_order_seq_cst);
+        }
+
+        std::uint64_t current = epoch.load(std::memory_order_relaxed);
+        std::size_t freed = 0;
+        while (freed < retired.size() && retired[freed].first + 2 <= current) {
+            delete retired[freed].second;
+            ++freed;
+        }
+        retired.erase(retired.begin(), retired.begin() + static_cast<std::ptrdiff_t>(freed));
+    }
+
+private:
+    std::atomic<Directory*>                 directory;
+    std::atomic<std::uint64_t>              epoch;
+    mutable std::atomic<unsigned int>       readers[2];     // за парністю епохи
+    mutable std::mutex                      writeMutex;
+    std::vector<std::unique_ptr<Directory>> directories;
+    std::vector<std::pair<std::uint64_t, const std::string*>> retired;     // (епоха, рядок)
+};
+
+#endif
@@ -4,8 +4,12 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <shared_mutex>
+#include <mutex>
 #include <cstdint>
 
+#include "posting_list.h"
+#include "metrics.h"
+
 class ForwardIndex {
 public:
     ForwardIndex() = default;
@@ -16,17 +20,17 @@ public:
     ForwardIndex& operator=(ForwardIndex&&)      = delete;
 
     void addWord(unsigned int docId, unsigned int wordId) {
-        std::unique_lock<std::shared_mutex> lock(mutex);
+        auto lock = writeLock();
         wordIdsByDoc[docId].insert(wordId);
     }
 
     void setWords(unsigned int docId, const std::unordered_set<unsigned int>& wordIds) {
-        std::unique_lock<std::shared_mutex> lock(mutex);
+        auto lock = writeLock();
         wordIdsByDoc[docId] = wordIds;
     }
 
     bool getWords(unsigned int docId, std::unordered_set<unsigned int>& outWordIds) const {
-        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto lock = readLock();
         auto it = wordIdsByDoc.find(docId);
         if (it == wordIdsByDoc.end()) {
             return false;
@@ -36,7 +40,7 @@ public:
     }
 
     bool removeDocument(unsigned int docId) {
-        std::unique_lock<std::shared_mutex> lock(mutex);
+        auto lock = writeLock();
         auto it = wordIdsByDoc.find(docId);
         if (it == wordIdsByDoc.end()) {
             return false;
@@ -45,27 +49,48 @@ public:
         return true;
     }
 
+    void getDocumentIds(PostingList& outDocIds) const {
+        auto lock = readLock();
+        outDocIds.clear();
+        for (const auto& entry : wordIdsByDoc) {
+            outDocIds.add(entry.first);
+        }
+    }
+
     void clear() {
-        std::unique_lock<std::shared_mutex> lock(mutex);
+        auto lock = writeLock();
         wordIdsByDoc.clear();
     }
 
     bool hasDocument(unsigned int docId) const {
-        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto lock = readLock();
         return wordIdsByDoc.find(docId) != wordIdsByDoc.end();
     }
 
     unsigned int size() const {
-        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto lock = readLock();
         return static_cast<unsigned int>(wordIdsByDoc.size());
     }
 
     bool empty() const {
-        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto lock = readLock();
         return wordIdsByDoc.empty();
     }
 
 private:
+    std::shared_lock<std::shared_mutex> readLock() const {
+        return metrics::lockShared(mutex, lockMetrics());
+    }
+
+    std::unique_lock<std::shared_mutex> writeLock() const {
+        return metrics::lockExclusive(mutex, lockMetrics());
+    }
+
+    static metrics::LockMetrics& lockMetrics() {
+        static metrics::LockMetrics& lm = metrics::lockMetricsFor("forward_index");
+        return lm;
+    }
+
     mutable std::shared_mutex mutex;
     std::unordered_map<unsigned int, std::unordered_set<unsigned int>> wordIdsByDoc;
 };
@@ -2,10 +2,17 @@
 #define INVERTED_INDEX_H
 
 #include <unordered_map>
-#include <unordered_set>
 #include <shared_mutex>
+#include <mutex>
 #include <cstdint>
+#include <cstddef>
 
+#include "posting_list.h"
+#include "metrics.h"
+
+// Плоский індекс слово -> документи під одним блокуванням, яким сервер
+// користувався до сегментованого індексу (segmented_index.h). Лишився тільки
+// як еталон для бенчмарку posting_insert.
 class InvertedIndex {
 public:
     InvertedIndex() = default;
@@ -16,71 +23,35 @@ public:
     InvertedIndex& operator=(InvertedIndex&&)      = delete;
 
     void addPosting(unsigned int wordId, unsigned int docId) {
-        std::unique_lock<std::shared_mutex> lock(mutex);
-        docIdsByWord[wordId].insert(docId);
-    }
-
-    void addPostingSet(unsigned int wordId, const std::unordered_set<unsigned int>& docIds) {
-        std::unique_lock<std::shared_mutex> lock(mutex);
-        std::unordered_set<unsigned int>& dest = docIdsByWord[wordId];
-        dest.insert(docIds.begin(), docIds.end());
-    }
-
-    bool getDocuments(unsigned int wordId, std::unordered_set<unsigned int>& outDocIds) const {
-        std::shared_lock<std::shared_mutex> lock(mutex);
-        auto it = docIdsByWord.find(wordId);
-        if (it == docIdsByWord.end()) {
-            return false;
-        }
-        outDocIds = it->second;
-        return true;
+        auto lock = writeLock();
+        docIdsByWord[wordId].add(docId);
     }
 
-    bool removePosting(unsigned int wordId, unsigned int docId) {
-        std::unique_lock<std::shared_mutex> lock(mutex);
-        auto it = docIdsByWord.find(wordId);
-        if (it == docIdsByWord.end()) {
-            return false;
-        }
-
-        std::unordered_set<unsigned int>& docs = it->second;
-        auto itDoc = docs.find(docId);
-        if (itDoc == docs.end()) {
-            return false;
+    std::size_t memoryUsage() const {
+        auto lock = readLock();
+        std::size_t bytes = 0;
+        for (const auto& entry : docIdsByWord) {
+            bytes += sizeof(entry.first) + entry.second.memoryUsage();
         }
-
-        docs.erase(itDoc);
-
-        if (docs.empty()) {
-            docIdsByWord.erase(it);
-        }
-
-        return true;
+        return bytes;
     }
 
-    void clear() {
-        std::unique_lock<std::shared_mutex> lock(mutex);
-        docIdsByWord.clear();
-    }
-
-    bool hasWord(unsigned int wordId) const {
-        std::shared_lock<std::shared_mutex> lock(mutex);
-        return docIdsByWord.find(wordId) != docIdsByWord.end();
+private:
+    std::shared_lock<std::shared_mutex> readLock() const {
+        return metrics::lockShared(mutex, lockMetrics());
     }
 
-    unsigned int size() const {
-        std::shared_lock<std::shared_mutex> lock(mutex);
-        return static_cast<unsigned int>(docIdsByWord.size());
+    std::unique_lock<std::shared_mutex> writeLock() const {
+        return metrics::lockExclusive(mutex, lockMetrics());
     }
 
-    bool empty() const {
-        std::shared_lock<std::shared_mutex> lock(mutex);
-        return docIdsByWord.empty();
+    static metrics::LockMetrics& lockMetrics() {
+        static metrics::LockMetrics& lm = metrics::lockMetricsFor("inverted_index");
+        return lm;
     }
 
-private:
     mutable std::shared_mutex mutex;
-    std::unordered_map<unsigned int, std::unordered_set<unsigned int>> docIdsByWord;
+    std::unordered_map<unsigned int, PostingList> docIdsByWord;
 };
 
 #endif
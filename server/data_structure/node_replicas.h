@@ -0,0 +1,220 @@
+#ifndef NODE_REPLICAS_H
+#define NODE_REPLICAS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+#include "numa_topology.h"
+#include "metrics.h"
+
+// Копії структури, що переважно читається, - по одній на NUMA-вузол.
+//   - кожну копію будує фоновий потік, закріплений за своїм вузлом, тож пам'ять
+//     розміщується на цьому вузлі (first-touch);
+//   - писач обгортає зміни первинної структури у WriteScope - копії застарівають;
+//   - local() повертає копію вузла поточного потоку, лише якщо після її побудови
+//     не почалася жодна зміна; інакше nullptr (читати первинну) і запит на перебудову;
+//   - перебудова чекає quietMs без змін, щоб не копіювати індекс під час масового запису.
+// На одновузловій машині потоків немає, а local() завжди повертає nullptr.
+
+template <typename T>
+class NodeReplicas {
+public:
+    typedef std::function<void(T&)> Builder;
+
+    class WriteScope {
+    public:
+        explicit WriteScope(NodeReplicas* replicas)
+            : replicas(replicas)
+        {
+            if (replicas != nullptr) {
+                replicas->begun.fetch_add(1, std::memory_order_seq_cst);
+            }
+        }
+
+        ~WriteScope() {
+            if (replicas != nullptr) {
+                replicas->finished.fetch_add(1, std::memory_order_seq_cst);
+            }
+        }
+
+        WriteScope(const WriteScope&)            = delete;
+        WriteScope& operator=(const WriteScope&) = delete;
+
+    private:
+        NodeReplicas* replicas;
+    };
+
+    NodeReplicas(const NumaTopology& topology, Builder builder, int quietMs = 200)
+        : topology(topology)
+        , builder(std::move(builder))
+        , quietMs(quietMs)
+        , begun(0)
+        , finished(0)
+        , stopping(false)
+        , hits(metrics::registry().counter("cw_numa_replica_reads_total", "Reads by replica freshness",
+                                           "result=\"local\""))
+        , misses(metrics::registry().counter("cw_numa_replica_reads_total", "Reads by replica freshness",
+                                             "result=\"stale\""))
+        , rebuilds(metrics::registry().counter("cw_numa_replica_rebuilds_total", "Node-local replica rebuilds"))
+    {
+        if (!enabled()) {
+            return;
+        }
+        for (std::size_t node = 0; node < topology.nodeCount(); ++node) {
+            slots.push_back(std::make_unique<Slot>());
+        }
+        for (std::size_t node = 0; node < topology.nodeCount(); ++node) {
+            slots[node]->thread = std::thread(&NodeReplicas::nodeLoop, this, node);
+            requestRebuild(node);
+        }
+    }
+
+    ~NodeReplicas() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+        for (auto& slot : slots) {
+            if (slot->thread.joinable()) {
+                slot->thread.join();
+            }
+        }
+    }
+
+    NodeReplicas(const NodeReplicas&)            = delete;
+    NodeReplicas& operator=(const NodeReplicas&) = delete;
+    NodeReplicas(NodeReplicas&&)                 = delete;
+    NodeReplicas& operator=(NodeReplicas&&)      = delete;
+
+    bool enabled() const {
+        return topology.isMultiNode();
+    }
+
+    std::shared_ptr<const T> local() const {
+        if (!enabled()) {
+            return nullptr;
+        }
+        std::size_t node = topology.currentNode();
+        std::shared_ptr<const Replica> replica = std::atomic_load(&slots[node]->replica);
+        if (replica && replica->version == begun.load(std::memory_order_seq_cst)) {
+            hits.add();
+            return std::shared_ptr<const T>(replica, &replica->value);
+        }
+        misses.add();
+        requestRebuild(node);
+        return nullptr;
+    }
+
+    // Чекає, поки копії всіх вузлів стануть свіжими (для бенчмарків).
+    bool waitUntilFresh(int timeoutMs) const {
+        if (!enabled()) {
+            return true;
+        }
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        for (std::size_t node = 0; node < slots.size(); ++node) {
+            for (;;) {
+                std::shared_ptr<const Replica> replica = std::atomic_load(&slots[node]->replica);
+                if (replica && replica->version == begun.load(std::memory_order_seq_cst)) {
+                    break;
+                }
+                if (std::chrono::steady_clock::now() >= deadline) {
+                    return false;
+                }
+                requestRebuild(node);
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+        }
+        return true;
+    }
+
+private:
+    struct Replica {
+        std::uint64_t version = 0;
+        T             value;
+    };
+
+    struct Slot {
+        std::shared_ptr<const Replica> replica;
+        std::atomic<bool>              requested{false};
+        std::thread                    thread;
+    };
+
+    void requestRebuild(std::size_t node) const {
+        if (slots[node]->requested.exchange(true)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        wakeUp.notify_all();
+    }
+
+    void nodeLoop(std::size_t node) {
+        topology.pinCurrentThreadToNode(node);
+        Slot& slot = *slots[node];
+
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            wakeUp.wait(lock, [&]() { return stopping || slot.requested.load(); });
+            if (stopping) {
+                return;
+            }
+            lock.unlock();
+            rebuild(slot);
+            lock.lock();
+        }
+    }
+
+    // Версія копії - лічильник початих змін на момент побудови; копія
+    // приймається, лише якщо жодна зміна не йшла під час копіювання.
+    void rebuild(Slot& slot) {
+        for (;;) {
+            std::uint64_t before = begun.load(std::memory_order_seq_cst);
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeUp.wait_for(lock, std::chrono::milliseconds(quietMs), [this]() { return stopping; });
+                if (stopping) {
+                    return;
+                }
+            }
+            if (begun.load(std::memory_order_seq_cst) != before
+                || finished.load(std::memory_order_seq_cst) != before) {
+                continue;
+            }
+
+            slot.requested.store(false);
+            auto replica = std::make_shared<Replica>();
+            builder(replica->value);
+            if (begun.load(std::memory_order_seq_cst) != before) {
+                slot.requested.store(true);
+                continue;
+            }
+            replica->version = before;
+            std::atomic_store(&slot.replica, std::shared_ptr<const Replica>(std::move(replica)));
+            rebuilds.add();
+            return;
+        }
+    }
+
+private:
+    NumaTopology                       topology;
+    Builder                            builder;
+    int                                quietMs;
+    std::atomic<std::uint64_t>         begun;
+    std::atomic<std::uint64_t>         finished;
+    bool                               stopping;
+    std::vector<std::unique_ptr<Slot>> slots;
+    mutable std::mutex                 mutex;
+    mutable std::condition_variable    wakeUp;
+    metrics::Counter&                  hits;
+    metrics::Counter&                  misses;
+    metrics::Counter&                  rebuilds;
+};
+
+#endif
@@ -0,0 +1,651 @@
+#ifndef POSTING_LIST_H
+#define POSTING_LIST_H
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "bit_utils.h"
+
+// Список документів слова у стилі Roaring:
+//   docId ділиться на старші 16 біт (ключ контейнера) і молодші 16 біт;
+//   розріджений контейнер - відсортований масив uint16_t (до 4096 значень),
+//   щільний контейнер - бітова мапа на 65536 біт.
+// Операції AND / OR / ANDNOT працюють для будь-якої комбінації контейнерів.
+
+class PostingList {
+public:
+    static constexpr std::size_t kArrayMax    = 4096;
+    static constexpr std::size_t kBitmapWords = 1024;
+
+    PostingList()
+        : total(0)
+    {}
+
+    bool add(unsigned int docId) {
+        std::uint16_t key = highBits(docId);
+        auto it = findContainer(key);
+        if (it == containers.end() || it->key != key) {
+            it = containers.insert(it, Container(key));
+        }
+        if (!it->addValue(lowBits(docId))) {
+            return false;
+        }
+        ++total;
+        return true;
+    }
+
+    bool remove(unsigned int docId) {
+        std::uint16_t key = highBits(docId);
+        auto it = findContainer(key);
+        if (it == containers.end() || it->key != key) {
+            return false;
+        }
+        if (!it->removeValue(lowBits(docId))) {
+            return false;
+        }
+        --total;
+        if (it->cardinality == 0) {
+            containers.erase(it);
+        }
+        return true;
+    }
+
+    bool contains(unsigned int docId) const {
+        std::uint16_t key = highBits(docId);
+        auto it = findContainer(key);
+        return it != containers.end() && it->key == key && it->containsValue(lowBits(docId));
+    }
+
+    std::size_t cardinality() const {
+        return total;
+    }
+
+    bool empty() const {
+        return total == 0;
+    }
+
+    void clear() {
+        containers.clear();
+        total = 0;
+    }
+
+    // Звільняє зайву ємність масивів (для списків, що більше не змінюються).
+    void shrinkToFit() {
+        containers.shrink_to_fit();
+        for (Container& c : containers) {
+            c.array.shrink_to_fit();
+        }
+    }
+
+    unsigned int maxDocId() const {
+        if (containers.empty()) {
+            return 0;
+        }
+        const Container& last = containers.back();
+        return (static_cast<unsigned int>(last.key) << 16) | last.maxValue();
+    }
+
+    std::size_t memoryUsage() const {
+        std::size_t bytes = sizeof(PostingList) + containers.capacity() * sizeof(Container);
+        for (const Container& c : containers) {
+            bytes += c.array.capacity() * sizeof(std::uint16_t);
+            bytes += c.bitmap.capacity() * sizeof(std::uint64_t);
+        }
+        return bytes;
+    }
+
+    // Обхід у порядку зростання docId.
+    template <typename F>
+    void forEach(F&& fn) const {
+        for (const Container& c : containers) {
+            unsigned int base = static_cast<unsigned int>(c.key) << 16;
+            if (c.isBitmap()) {
+                for (std::size_t i = 0; i < kBitmapWords; ++i) {
+                    std::uint64_t w = c.bitmap[i];
+                    while (w != 0) {
+                        fn(base + static_cast<unsigned int>(i * 64) + countTrailingZeros(w));
+                        w &= w - 1;
+                    }
+                }
+            } else {
+                for (std::uint16_t v : c.array) {
+                    fn(base + v);
+                }
+            }
+        }
+    }
+
+    void toVector(std::vector<unsigned int>& out) const {
+        out.clear();
+        out.reserve(total);
+        forEach([&out](unsigned int docId) { out.push_back(docId); });
+    }
+
+    // Додає до out docId з [lo, hi) у порядку зростання.
+    void appendRange(unsigned int lo, unsigned int hi, std::vector<unsigned int>& out) const {
+        if (lo >= hi) {
+            return;
+        }
+        for (auto it = findContainer(highBits(lo)); it != containers.end(); ++it) {
+            unsigned int base = static_cast<unsigned int>(it->key) << 16;
+            if (base >= hi) {
+                break;
+            }
+            if (it->isBitmap()) {
+                unsigned int from = lo > base ? lo - base : 0;
+                unsigned int to   = hi - base < 65536u ? hi - base : 65536u;
+                for (unsigned int word = from >> 6; word < (to + 63) >> 6; ++word) {
+                    std::uint64_t w = it->bitmap[word];
+                    while (w != 0) {
+                        unsigned int v = word * 64 + countTrailingZeros(w);
+                        w &= w - 1;
+                        if (v >= from && v < to) {
+                            out.push_back(base + v);
+                        }
+                    }
+                }
+            } else {
+                auto first = it->array.begin();
+                if (lo > base) {
+                    first = std::lower_bound(first, it->array.end(), static_cast<std::uint16_t>(lo - base));
+                }
+                for (; first != it->array.end() && base + *first < hi; ++first) {
+                    out.push_back(base + *first);
+                }
+            }
+        }
+    }
+
+    // Додає (OR) docId з [lo, hi) до бітової мапи, де біт 0 відповідає lo.
+    // lo має бути кратним 64; words - не менше (hi - lo + 63) / 64 слів.
+    void orIntoBitmap(unsigned int lo, unsigned int hi, std::uint64_t* words) const {
+        if (lo >= hi) {
+            return;
+        }
+        for (auto it = findContainer(highBits(lo)); it != containers.end(); ++it) {
+            unsigned int base = static_cast<unsigned int>(it->key) << 16;
+            if (base >= hi) {
+                break;
+            }
+            if (it->isBitmap()) {
+                unsigned int from = lo > base ? (lo - base) >> 6 : 0;
+                unsigned int to   = hi - base < 65536u ? (hi - base + 63) >> 6 : 1024u;
+                for (unsigned int word = from; word < to; ++word) {
+                    std::uint64_t w = it->bitmap[word];
+                    unsigned int first = base + word * 64;
+                    if (first + 64 > hi) {
+                        w &= (std::uint64_t(1) << (hi - first)) - 1;
+                    }
+                    words[(first - lo) >> 6] |= w;
+                }
+            } else {
+                auto first = it->array.begin();
+                if (lo > base) {
+                    first = std::lower_bound(first, it->array.end(), static_cast<std::uint16_t>(lo - base));
+                }
+                for (; first != it->array.end() && base + *first < hi; ++first) {
+                    unsigned int offset = base + *first - lo;
+                    words[offset >> 6] |= std::uint64_t(1) << (offset & 63);
+                }
+            }
+        }
+    }
+
+    static PostingList intersect(const PostingList& a, const PostingList& b) {
+        PostingList result;
+        auto ia = a.containers.begin();
+        auto ib = b.containers.begin();
+        while (ia != a.containers.end() && ib != b.containers.end()) {
+            if (ia->key < ib->key) {
+                ++ia;
+            } else if (ib->key < ia->key) {
+                ++ib;
+            } else {
+                Container c(ia->key);
+                andContainers(*ia, *ib, c);
+                result.appendContainer(std::move(c));
+                ++ia;
+                ++ib;
+            }
+        }
+        return result;
+    }
+
+    static PostingList unite(const PostingList& a, const PostingList& b) {
+        PostingList result;
+        result.containers.reserve(a.containers.size() + b.containers.size());
+        auto ia = a.containers.begin();
+        auto ib = b.containers.begin();
+        while (ia != a.containers.end() || ib != b.containers.end()) {
+            if (ib == b.containers.end() || (ia != a.containers.end() && ia->key < ib->key)) {
+                result.appendContainer(Container(*ia));
+                ++ia;
+            } else if (ia == a.containers.end() || ib->key < ia->key) {
+                result.appendContainer(Container(*ib));
+                ++ib;
+            } else {
+                Container c(ia->key);
+                orContainers(*ia, *ib, c);
+                result.appendContainer(std::move(c));
+                ++ia;
+                ++ib;
+            }
+        }
+        return result;
+    }
+
+    // Об'єднання кількох списків за один прохід: контейнери з однаковим ключем
+    // збираються в одну бітову мапу, а не зливаються попарно з проміжними копіями.
+    static PostingList uniteMany(const std::vector<const PostingList*>& lists) {
+        if (lists.empty()) {
+            return PostingList();
+        }
+        if (lists.size() == 1) {
+            return *lists.front();
+        }
+
+        PostingList result;
+        std::vector<std::size_t> pos(lists.size(), 0);
+        for (;;) {
+            bool          found = false;
+            std::uint16_t key   = 0;
+            for (std::size_t i = 0; i < lists.size(); ++i) {
+                if (pos[i] < lists[i]->containers.size()) {
+                    std::uint16_t k = lists[i]->containers[pos[i]].key;
+                    if (!found || k < key) {
+                        key   = k;
+                        found = true;
+                    }
+                }
+            }
+            if (!found) {
+                break;
+            }
+
+            std::size_t      matches = 0;
+            const Container* single  = nullptr;
+            for (std::size_t i = 0; i < lists.size(); ++i) {
+                if (pos[i] < lists[i]->containers.size() && lists[i]->containers[pos[i]].key == key) {
+                    ++matches;
+                    single = &lists[i]->containers[pos[i]];
+                }
+            }
+            if (matches == 1) {
+                result.appendContainer(Container(*single));
+            } else {
+                // Малі масиви зливаються без проміжного бітмапа.
+                std::size_t arrayTotal = 0;
+                bool        allArrays  = true;
+                for (std::size_t i = 0; i < lists.size(); ++i) {
+                    if (pos[i] < lists[i]->containers.size() && lists[i]->containers[pos[i]].key == key) {
+                        const Container& src = lists[i]->containers[pos[i]];
+                        allArrays = allArrays && !src.isBitmap();
+                        arrayTotal += src.array.size();
+                    }
+                }
+                Container c(key);
+                if (allArrays && arrayTotal <= kArrayMax) {
+                    std::vector<std::uint16_t> merged;
+                    for (std::size_t i = 0; i < lists.size(); ++i) {
+                        if (pos[i] >= lists[i]->containers.size() || lists[i]->containers[pos[i]].key != key) {
+                            continue;
+                        }
+                        const std::vector<std::uint16_t>& src = lists[i]->containers[pos[i]].array;
+                        merged.clear();
+                        merged.reserve(c.array.size() + src.size());
+                        std::set_union(c.array.begin(), c.array.end(), src.begin(), src.end(),
+                                       std::back_inserter(merged));
+                        c.array.swap(merged);
+                    }
+                    c.cardinality = static_cast<std::uint32_t>(c.array.size());
+                } else {
+                    c.bitmap.assign(kBitmapWords, 0);
+                    for (std::size_t i = 0; i < lists.size(); ++i) {
+                        if (pos[i] >= lists[i]->containers.size() || lists[i]->containers[pos[i]].key != key) {
+                            continue;
+                        }
+                        const Container& src = lists[i]->containers[pos[i]];
+                        if (src.isBitmap()) {
+                            for (std::size_t w = 0; w < kBitmapWords; ++w) {
+                                c.bitmap[w] |= src.bitmap[w];
+                            }
+                        } else {
+                            for (std::uint16_t v : src.array) {
+                                c.bitmap[v >> 6] |= std::uint64_t(1) << (v & 63);
+                            }
+                        }
+                    }
+                    c.normalizeBitmap();
+                }
+                result.appendContainer(std::move(c));
+            }
+            for (std::size_t i = 0; i < lists.size(); ++i) {
+                if (pos[i] < lists[i]->containers.size() && lists[i]->containers[pos[i]].key == key) {
+                    ++pos[i];
+                }
+            }
+        }
+        return result;
+    }
+
+    // a AND NOT b
+    static PostingList subtract(const PostingList& a, const PostingList& b) {
+        PostingList result;
+        auto ib = b.containers.begin();
+        for (auto ia = a.containers.begin(); ia != a.containers.end(); ++ia) {
+            while (ib != b.containers.end() && ib->key < ia->key) {
+                ++ib;
+            }
+            if (ib == b.containers.end() || ib->key != ia->key) {
+                result.appendContainer(Container(*ia));
+                continue;
+            }
+            Container c(ia->key);
+            andNotContainers(*ia, *ib, c);
+            result.appendContainer(std::move(c));
+        }
+        return result;
+    }
+
+    void intersectWith(const PostingList& other) {
+        *this = intersect(*this, other);
+    }
+
+    void uniteWith(const PostingList& other) {
+        *this = unite(*this, other);
+    }
+
+    void subtractWith(const PostingList& other) {
+        *this = subtract(*this, other);
+    }
+
+    bool operator==(const PostingList& other) const {
+        if (total != other.total || containers.size() != other.containers.size()) {
+            return false;
+        }
+        std::vector<unsigned int> lhs;
+        std::vector<unsigned int> rhs;
+        toVector(lhs);
+        other.toVector(rhs);
+        return lhs == rhs;
+    }
+
+    bool operator!=(const PostingList& other) const {
+        return !(*this == other);
+    }
+
+private:
+    struct Container {
+        explicit Container(std::uint16_t k)
+            : key(k)
+            , cardinality(0)
+        {}
+
+        bool isBitmap() const {
+            return !bitmap.empty();
+        }
+
+        bool containsValue(std::uint16_t v) const {
+            if (isBitmap()) {
+                return (bitmap[v >> 6] >> (v & 63)) & 1;
+            }
+            return std::binary_search(array.begin(), array.end(), v);
+        }
+
+        bool addValue(std::uint16_t v) {
+            if (isBitmap()) {
+                std::uint64_t mask = std::uint64_t(1) << (v & 63);
+                if (bitmap[v >> 6] & mask) {
+                    return false;
+                }
+                bitmap[v >> 6] |= mask;
+                ++cardinality;
+                return true;
+            }
+
+            // Документи зазвичай додаються у порядку зростання docId.
+            if (array.empty() || array.back() < v) {
+                if (array.size() >= kArrayMax) {
+                    toBitmap();
+                    return addValue(v);
+                }
+                array.push_back(v);
+                ++cardinality;
+                return true;
+            }
+
+            auto it = std::lower_bound(array.begin(), array.end(), v);
+            if (*it == v) {
+                return false;
+            }
+            if (array.size() >= kArrayMax) {
+                toBitmap();
+                return addValue(v);
+            }
+            array.insert(it, v);
+            ++cardinality;
+            return true;
+        }
+
+        bool removeValue(std::uint16_t v) {
+            if (isBitmap()) {
+                std::uint64_t mask = std::uint64_t(1) << (v & 63);
+                if (!(bitmap[v >> 6] & mask)) {
+                    return false;
+                }
+                bitmap[v >> 6] &= ~mask;
+                --cardinality;
+                if (cardinality <= kArrayMax) {
+                    toArray();
+                }
+                return true;
+            }
+
+            auto it = std::lower_bound(array.begin(), array.end(), v);
+            if (it == array.end() || *it != v) {
+                return false;
+            }
+            array.erase(it);
+            --cardinality;
+            return true;
+        }
+
+        std::uint16_t maxValue() const {
+            if (!isBitmap()) {
+                return array.back();
+            }
+            for (std::size_t i = kBitmapWords; i-- > 0;) {
+                if (bitmap[i] != 0) {
+                    unsigned int top = 63;
+                    while (!((bitmap[i] >> top) & 1)) {
+                        --top;
+                    }
+                    return static_cast<std::uint16_t>(i * 64 + top);
+                }
+            }
+            return 0;
+        }
+
+        void toBitmap() {
+            bitmap.assign(kBitmapWords, 0);
+            for (std::uint16_t v : array) {
+                bitmap[v >> 6] |= std::uint64_t(1) << (v & 63);
+            }
+            std::vector<std::uint16_t>().swap(array);
+        }
+
+        void toArray() {
+            array.clear();
+            array.reserve(cardinality);
+            for (std::size_t i = 0; i < kBitmapWords; ++i) {
+                std::uint64_t w = bitmap[i];
+                while (w != 0) {
+                    array.push_back(static_cast<std::uint16_t>(i * 64 + countTrailingZeros(w)));
+                    w &= w - 1;
+                }
+            }
+            std::vector<std::uint64_t>().swap(bitmap);
+        }
+
+        // Після бітових операцій над мапами: перерахувати і,
+        // якщо значень мало, перейти на масив.
+        void normalizeBitmap() {
+            cardinality = 0;
+            for (std::uint64_t w : bitmap) {
+                cardinality += popCount(w);
+            }
+            if (cardinality <= kArrayMax) {
+                toArray();
+            }
+        }
+
+        std::uint16_t              key;
+        std::uint32_t              cardinality;
+        std::vector<std::uint16_t> array;
+        std::vector<std::uint64_t> bitmap;
+    };
+
+    static void andContainers(const Container& a, const Container& b, Container& out) {
+        if (a.isBitmap() && b.isBitmap()) {
+            out.bitmap.resize(kBitmapWords);
+            for (std::size_t i = 0; i < kBitmapWords; ++i) {
+                out.bitmap[i] = a.bitmap[i] & b.bitmap[i];
+            }
+            out.normalizeBitmap();
+            return;
+        }
+
+        if (a.isBitmap() || b.isBitmap()) {
+            const Container& arr = a.isBitmap() ? b : a;
+            const Container& bmp = a.isBitmap() ? a : b;
+            out.array.reserve(arr.array.size());
+            for (std::uint16_t v : arr.array) {
+                if ((bmp.bitmap[v >> 6] >> (v & 63)) & 1) {
+                    out.array.push_back(v);
+                }
+            }
+            out.cardinality = static_cast<std::uint32_t>(out.array.size());
+            return;
+        }
+
+        const std::vector<std::uint16_t>& small = a.array.size() <= b.array.size() ? a.array : b.array;
+        const std::vector<std::uint16_t>& large = a.array.size() <= b.array.size() ? b.array : a.array;
+        out.array.reserve(small.size());
+
+        if (small.size() * 32 < large.size()) {
+            // Сильно різні розміри - бінарний пошук з просуванням.
+            auto pos = large.begin();
+            for (std::uint16_t v : small) {
+                pos = std::lower_bound(pos, large.end(), v);
+                if (pos == large.end()) {
+                    break;
+                }
+                if (*pos == v) {
+                    out.array.push_back(v);
+                }
+            }
+        } else {
+            std::set_intersection(small.begin(), small.end(), large.begin(), large.end(),
+                                  std::back_inserter(out.array));
+        }
+        out.cardinality = static_cast<std::uint32_t>(out.array.size());
+    }
+
+    static void orContainers(const Container& a, const Container& b, Container& out) {
+        if (!a.isBitmap() && !b.isBitmap() && a.array.size() + b.array.size() <= kArrayMax) {
+            out.array.reserve(a.array.size() + b.array.size());
+            std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                           std::back_inserter(out.array));
+            out.cardinality = static_cast<std::uint32_t>(out.array.size());
+            return;
+        }
+
+        if (a.isBitmap() && b.isBitmap()) {
+            out.bitmap.resize(kBitmapWords);
+            for (std::size_t i = 0; i < kBitmapWords; ++i) {
+                out.bitmap[i] = a.bitmap[i] | b.bitmap[i];
+            }
+        } else if (a.isBitmap() || b.isBitmap()) {
+            const Container& arr = a.isBitmap() ? b : a;
+            const Container& bmp = a.isBitmap() ? a : b;
+            out.bitmap = bmp.bitmap;
+            for (std::uint16_t v : arr.array) {
+                out.bitmap[v >> 6] |= std::uint64_t(1) << (v & 63);
+            }
+        } else {
+            out.bitmap.assign(kBitmapWords, 0);
+            for (std::uint16_t v : a.array) {
+                out.bitmap[v >> 6] |= std::uint64_t(1) << (v & 63);
+            }
+            for (std::uint16_t v : b.array) {
+                out.bitmap[v >> 6] |= std::uint64_t(1) << (v & 63);
+            }
+        }
+        out.normalizeBitmap();
+    }
+
+    static void andNotContainers(const Container& a, const Container& b, Container& out) {
+        if (!a.isBitmap()) {
+            out.array.reserve(a.array.size());
+            if (b.isBitmap()) {
+                for (std::uint16_t v : a.array) {
+                    if (!((b.bitmap[v >> 6] >> (v & 63)) & 1)) {
+                        out.array.push_back(v);
+                    }
+                }
+            } else {
+                std::set_difference(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                                    std::back_inserter(out.array));
+            }
+            out.cardinality = static_cast<std::uint32_t>(out.array.size());
+            return;
+        }
+
+        out.bitmap = a.bitmap;
+        if (b.isBitmap()) {
+            for (std::size_t i = 0; i < kBitmapWords; ++i) {
+                out.bitmap[i] &= ~b.bitmap[i];
+            }
+        } else {
+            for (std::uint16_t v : b.array) {
+                out.bitmap[v >> 6] &= ~(std::uint64_t(1) << (v & 63));
+            }
+        }
+        out.normalizeBitmap();
+    }
+
+    void appendContainer(Container&& c) {
+        if (c.cardinality == 0) {
+            return;
+        }
+        total += c.cardinality;
+        containers.push_back(std::move(c));
+    }
+
+    std::vector<Container>::iterator findContainer(std::uint16_t key) {
+        return std::lower_bound(containers.begin(), containers.end(), key,
+                                [](const Container& c, std::uint16_t k) { return c.key < k; });
+    }
+
+    std::vector<Container>::const_iterator findContainer(std::uint16_t key) const {
+        return std::lower_bound(containers.begin(), containers.end(), key,
+                                [](const Container& c, std::uint16_t k) { return c.key < k; });
+    }
+
+    static std::uint16_t highBits(unsigned int docId) {
+        return static_cast<std::uint16_t>(docId >> 16);
+    }
+
+    static std::uint16_t lowBits(unsigned int docId) {
+        return static_cast<std::uint16_t>(docId & 0xFFFF);
+    }
+
+private:
+    std::vector<Container> containers;
+    std::size_t            total;
+};
+
+#endif
@@ -0,0 +1,645 @@
+#ifndef SEGMENTED_INDEX_H
+#define SEGMENTED_INDEX_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "posting_list.h"
+#include "thread_pool.h"
+#include "metrics.h"
+#include "deadline.h"
+
+// Інвертований індекс із сегментів (як у LSM):
+//   - нові документи пишуться в невеликий змінний сегмент (хеш-таблиця);
+//   - коли в ньому набирається flushPostings записів, він перетворюється на
+//     незмінний сегмент: відсортований масив wordId + компактні списки документів.
+//     Під блокуванням записи лише відокремлюються (заморожені записи), а сам
+//     сегмент будується вже без нього; поки він будується, пошук читає
+//     заморожені записи;
+//   - видалення з незмінного сегмента - лише позначка docId у бітовій мапі
+//     видалених цього сегмента; сам сегмент не змінюється;
+//   - злиття за рівнями: сегменти одного рівня (розмір у mergeFactor^рівень
+//     разів більший за flushPostings) зливаються по mergeFactor штук у фоні,
+//     видалені документи при цьому відкидаються. Одночасно йде не більше одного
+//     злиття, тож фонова робота обмежена;
+//   - пошук об'єднує результати всіх сегментів. Часті слова є в кожному
+//     сегменті, тож ціна запиту росте з кількістю сегментів - звідси великий
+//     поріг скидання за замовчуванням (близько кількох МБ списків).
+// docId живий не більше ніж в одному сегменті: переіндексація спершу видаляє
+// документ, а потім додає його у змінний сегмент.
+
+class SegmentedIndex {
+public:
+    static constexpr std::size_t kDefaultFlushPostings = 1 << 20;
+    static constexpr std::size_t kDefaultMergeFactor   = 4;
+
+    SegmentedIndex()
+        : flushPostings(kDefaultFlushPostings)
+        , mergeFactor(kDefaultMergeFactor)
+        , pool(nullptr)
+        , mutablePostingCount(0)
+        , mergeRunning(false)
+        , mergeRequested(false)
+    {}
+
+    ~SegmentedIndex() {
+        waitForMerges();
+    }
+
+    SegmentedIndex(const SegmentedIndex&)            = delete;
+    SegmentedIndex& operator=(const SegmentedIndex&) = delete;
+    SegmentedIndex(SegmentedIndex&&)                 = delete;
+    SegmentedIndex& operator=(SegmentedIndex&&)      = delete;
+
+    // Пул для фонових злиттів; nullptr - злиття виконується в потоці писача.
+    void setMergePool(ThreadPool* mergePool) {
+        std::lock_guard<std::mutex> lock(mergeMutex);
+        pool = mergePool;
+    }
+
+    void setMergePolicy(std::size_t flushAtPostings, std::size_t factor) {
+        auto lock = writeLock();
+        flushPostings = flushAtPostings == 0 ? 1 : flushAtPostings;
+        mergeFactor   = factor < 2 ? 2 : factor;
+    }
+
+    // Усі слова документа за одне захоплення блокування.
+    void addDocument(unsigned int docId, const std::unordered_set<unsigned int>& wordIds) {
+        std::shared_ptr<const FrozenPostings> frozen;
+        {
+            auto lock = writeLock();
+            for (unsigned int wordId : wordIds) {
+                if (mutablePostings[wordId].add(docId)) {
+                    ++mutablePostingCount;
+                }
+            }
+            mutableDocs.add(docId);
+            if (mutablePostingCount >= flushPostings) {
+                frozen = freezeLocked();
+            }
+        }
+        if (frozen != nullptr) {
+            commitFlush(frozen, buildSegment(*frozen));
+            scheduleMerge();
+        }
+    }
+
+    // wordIds - слова документа (з прямого індексу), потрібні лише змінному сегменту.
+    void removeDocument(unsigned int docId, const std::unordered_set<unsigned int>& wordIds) {
+        auto lock = writeLock();
+        if (mutableDocs.remove(docId)) {
+            for (unsigned int wordId : wordIds) {
+                auto it = mutablePostings.find(wordId);
+                if (it != mutablePostings.end() && it->second.remove(docId)) {
+                    --mutablePostingCount;
+                    if (it->second.empty()) {
+                        mutablePostings.erase(it);
+                    }
+                }
+            }
+        }
+        for (FrozenSlot& slot : flushing) {
+            if (slot.frozen->docs.contains(docId)) {
+                slot.deleted.add(docId);
+            }
+        }
+        for (SegmentSlot& slot : segments) {
+            if (slot.segment->docs.contains(docId)) {
+                slot.deleted.add(docId);
+            }
+        }
+    }
+
+    // Живі документи слова з усіх сегментів.
+    bool getDocuments(unsigned int wordId, PostingList& outDocIds) const {
+        auto lock = readLock();
+
+        std::vector<const PostingList*> parts;
+        std::vector<PostingList>        filtered;     // частини без видалених документів
+        filtered.reserve(flushing.size() + segments.size());
+        auto addPart = [&](const PostingList* docs, const PostingList& deleted) {
+            if (docs == nullptr) {
+                return;
+            }
+            if (deleted.empty()) {
+                parts.push_back(docs);
+            } else {
+                filtered.push_back(PostingList::subtract(*docs, deleted));
+                parts.push_back(&filtered.back());
+            }
+        };
+        auto it = mutablePostings.find(wordId);
+        if (it != mutablePostings.end()) {
+            parts.push_back(&it->second);
+        }
+        for (const FrozenSlot& slot : flushing) {
+            addPart(slot.frozen->find(wordId), slot.deleted);
+        }
+        for (const SegmentSlot& slot : segments) {
+            addPart(slot.segment->find(wordId), slot.deleted);
+        }
+        outDocIds = PostingList::uniteMany(parts);
+        return !outDocIds.empty();
+    }
+
+    // Документи з усіма словами. Документ живе лише в одному сегменті, тож
+    // перетин рахується в кожному сегменті окремо, а об'єднуються вже малі
+    // результати, а не повні списки частих слів.
+    bool intersectDocuments(const std::vector<unsigned int>& wordIds,
+                            PostingList& outDocIds,
+                            const Deadline* deadline = nullptr) const {
+        outDocIds = PostingList();
+        if (wordIds.empty()) {
+            return false;
+        }
+        auto lock = readLock();
+
+        std::vector<PostingList>        partials;
+        std::vector<const PostingList*> lists(wordIds.size());
+        partials.reserve(flushing.size() + segments.size() + 1);
+        auto intersectPart = [&](const PostingList* deleted) {
+            std::sort(lists.begin(), lists.end(),
+                      [](const PostingList* lhs, const PostingList* rhs) {
+                          return lhs->cardinality() < rhs->cardinality();
+                      });
+            PostingList part = *lists.front();
+            for (std::size_t i = 1; i < lists.size() && !part.empty(); ++i) {
+                part.intersectWith(*lists[i]);
+            }
+            if (deleted != nullptr && !part.empty()) {
+                part.subtractWith(*deleted);
+            }
+            if (!part.empty()) {
+                partials.push_back(std::move(part));
+            }
+        };
+
+        bool present = true;
+        for (std::size_t i = 0; i < wordIds.size() && present; ++i) {
+            auto it = mutablePostings.find(wordIds[i]);
+            present = it != mutablePostings.end();
+            lists[i] = present ? &it->second : nullptr;
+        }
+        if (present) {
+            intersectPart(nullptr);
+        }
+        for (const FrozenSlot& slot : flushing) {
+            present = true;
+            for (std::size_t i = 0; i < wordIds.size() && present; ++i) {
+                lists[i] = slot.frozen->find(wordIds[i]);
+                present = lists[i] != nullptr;
+            }
+            if (present) {
+                intersectPart(slot.deleted.empty() ? nullptr : &slot.deleted);
+            }
+        }
+        for (const SegmentSlot& slot : segments) {
+            if (deadline != nullptr && deadline->expired()) {
+                return false;
+            }
+            present = true;
+            for (std::size_t i = 0; i < wordIds.size() && present; ++i) {
+                lists[i] = slot.segment->find(wordIds[i]);
+                present = lists[i] != nullptr;
+            }
+            if (present) {
+                intersectPart(slot.deleted.empty() ? nullptr : &slot.deleted);
+            }
+        }
+
+        std::vector<const PostingList*> parts;
+        parts.reserve(partials.size());
+        for (const PostingList& part : partials) {
+            parts.push_back(&part);
+        }
+        outDocIds = PostingList::uniteMany(parts);
+        return !outDocIds.empty();
+    }
+
+    // Оцінка для планувальника: видалені документи не віднімаються.
+    std::size_t getCardinality(unsigned int wordId) const {
+        auto lock = readLock();
+        std::size_t count = 0;
+        auto it = mutablePostings.find(wordId);
+        if (it != mutablePostings.end()) {
+            count += it->second.cardinality();
+        }
+        for (const FrozenSlot& slot : flushing) {
+            const PostingList* docs = slot.frozen->find(wordId);
+            if (docs != nullptr) {
+                count += docs->cardinality();
+            }
+        }
+        for (const SegmentSlot& slot : segments) {
+            const PostingList* docs = slot.segment->find(wordId);
+            if (docs != nullptr) {
+                count += docs->cardinality();
+            }
+        }
+        return count;
+    }
+
+    void clear() {
+        auto lock = writeLock();
+        mutablePostings.clear();
+        mutableDocs.clear();
+        mutablePostingCount = 0;
+        flushing.clear();
+        segments.clear();
+    }
+
+    // Повна копія з власними сегментами (копії індексу на NUMA-вузлах:
+    // пам'ять має належати потоку, що копіює). Злиття в копії не запускаються.
+    void copyFrom(const SegmentedIndex& other) {
+        if (&other == this) {
+            return;
+        }
+        auto otherLock = other.readLock();
+        auto lock      = writeLock();
+        mutablePostings     = other.mutablePostings;
+        mutableDocs         = other.mutableDocs;
+        mutablePostingCount = other.mutablePostingCount;
+        flushing.clear();
+        segments.clear();
+        segments.reserve(other.flushing.size() + other.segments.size());
+        // Незавершені скидання копія добудовує сама: у ній їх ніхто не завершить.
+        for (const FrozenSlot& slot : other.flushing) {
+            SegmentSlot copy;
+            copy.segment = buildSegment(*slot.frozen);
+            copy.deleted = slot.deleted;
+            segments.push_back(std::move(copy));
+        }
+        for (const SegmentSlot& slot : other.segments) {
+            SegmentSlot copy;
+            copy.segment = std::make_shared<const Segment>(*slot.segment);
+            copy.deleted = slot.deleted;
+            segments.push_back(std::move(copy));
+        }
+    }
+
+    std::size_t memoryUsage() const {
+        auto lock = readLock();
+        std::size_t bytes = mutableDocs.memoryUsage();
+        for (const auto& entry : mutablePostings) {
+            bytes += sizeof(entry.first) + entry.second.memoryUsage();
+        }
+        for (const FrozenSlot& slot : flushing) {
+            bytes += slot.frozen->memoryUsage() + slot.deleted.memoryUsage();
+        }
+        for (const SegmentSlot& slot : segments) {
+            bytes += slot.segment->memoryUsage() + slot.deleted.memoryUsage();
+        }
+        return bytes;
+    }
+
+    std::size_t segmentCount() const {
+        auto lock = readLock();
+        return segments.size();
+    }
+
+    // Чекає завершення фонових злиттів (бенчмарки, деструктор).
+    void waitForMerges() const {
+        std::unique_lock<std::mutex> lock(mergeMutex);
+        mergeDone.wait(lock, [this]() { return !mergeRunning; });
+    }
+
+private:
+    // Незмінний сегмент: words відсортовані, postings[i] - документи words[i].
+    struct Segment {
+        std::vector<unsigned int> words;
+        std::vector<PostingList>  postings;
+        PostingList               docs;
+        std::size_t               postingCount = 0;
+
+        const PostingList* find(unsigned int wordId) const {
+            auto it = std::lower_bound(words.begin(), words.end(), wordId);
+            if (it == words.end() || *it != wordId) {
+                return nullptr;
+            }
+            return &postings[static_cast<std::size_t>(it - words.begin())];
+        }
+
+        std::size_t memoryUsage() const {
+            std::size_t bytes = sizeof(Segment) + words.capacity() * sizeof(unsigned int) + docs.memoryUsage();
+            for (const PostingList& list : postings) {
+                bytes += list.memoryUsage();
+            }
+            return bytes;
+        }
+    };
+
+    struct SegmentSlot {
+        std::shared_ptr<const Segment> segment;
+        PostingList                    deleted;    // видалені docId цього сегмента
+    };
+
+    // Записи змінного сегмента, відокремлені для скидання. Незмінні: поки з
+    // них будується сегмент, їх так само читає пошук.
+    struct FrozenPostings {
+        std::unordered_map<unsigned int, PostingList> postings;
+        PostingList                                   docs;
+        std::size_t                                   postingCount = 0;
+
+        const PostingList* find(unsigned int wordId) const {
+            auto it = postings.find(wordId);
+            return it == postings.end() ? nullptr : &it->second;
+        }
+
+        std::size_t memoryUsage() const {
+            std::size_t bytes = sizeof(FrozenPostings) + docs.memoryUsage();
+            for (const auto& entry : postings) {
+                bytes += sizeof(entry.first) + entry.second.memoryUsage();
+            }
+            return bytes;
+        }
+    };
+
+    struct FrozenSlot {
+        std::shared_ptr<const FrozenPostings> frozen;
+        PostingList                           deleted;    // видалені під час побудови сегмента
+    };
+
+    // Кандидати злиття та стан їхніх видалень на момент вибору.
+    struct MergePlan {
+        std::vector<SegmentSlot> sources;
+    };
+
+    // Відокремлює записи змінного сегмента; nullptr - скидати нічого.
+    std::shared_ptr<const FrozenPostings> freezeLocked() {
+        if (mutablePostings.empty()) {
+            mutableDocs.clear();
+            mutablePostingCount = 0;
+            return nullptr;
+        }
+
+        auto frozen = std::make_shared<FrozenPostings>();
+        frozen->postings.swap(mutablePostings);
+        std::swap(frozen->docs, mutableDocs);
+        frozen->postingCount = mutablePostingCount;
+        mutablePostingCount  = 0;
+
+        FrozenSlot slot;
+        slot.frozen = frozen;
+        flushing.push_back(std::move(slot));
+        return frozen;
+    }
+
+    // Без блокування: заморожені записи незмінні, тож списки копіюються, а не
+    // переносяться - пошук може читати їх одночасно.
+    static std::shared_ptr<const Segment> buildSegment(const FrozenPostings& frozen) {
+        auto segment = std::make_shared<Segment>();
+        segment->words.reserve(frozen.postings.size());
+        for (const auto& entry : frozen.postings) {
+            segment->words.push_back(entry.first);
+        }
+        std::sort(segment->words.begin(), segment->words.end());
+        segment->postings.reserve(segment->words.size());
+        for (unsigned int wordId : segment->words) {
+            segment->postings.push_back(*frozen.find(wordId));
+            segment->postings.back().shrinkToFit();
+        }
+        segment->docs = frozen.docs;
+        segment->docs.shrinkToFit();
+        segment->postingCount = frozen.postingCount;
+        return segment;
+    }
+
+    // Заморожені записи замінюються сегментом разом із видаленнями, що надійшли
+    // під час побудови. Якщо їх уже немає (індекс очистили), сегмент відкидається.
+    void commitFlush(const std::shared_ptr<const FrozenPostings>& frozen,
+                     const std::shared_ptr<const Segment>& segment) {
+        auto lock = writeLock();
+        auto it = std::find_if(flushing.begin(), flushing.end(),
+                               [&](const FrozenSlot& slot) { return slot.frozen == frozen; });
+        if (it == flushing.end()) {
+            return;
+        }
+
+        SegmentSlot slot;
+        slot.segment = segment;
+        slot.deleted = std::move(it->deleted);
+        segments.push_back(std::move(slot));
+        flushing.erase(it);
+        segmentMetrics().flushes.add();
+        segmentMetrics().segments.set(static_cast<std::int64_t>(segments.size()));
+    }
+
+    void scheduleMerge() {
+        ThreadPool* mergePool = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mergeMutex);
+            mergeRequested = true;
+            if (mergeRunning) {
+                return;
+            }
+            mergeRunning = true;
+            mergePool    = pool;
+        }
+        if (mergePool != nullptr) {
+            mergePool->post([this]() { runMerges(); });
+        } else {
+            runMerges();
+        }
+    }
+
+    void runMerges() {
+        MergePlan plan;
+        for (;;) {
+            {
+                std::lock_guard<std::mutex> lock(mergeMutex);
+                if (!mergeRequested) {
+                    // Під блокуванням: після нього деструктор може знищити об'єкт.
+                    mergeRunning = false;
+                    mergeDone.notify_all();
+                    return;
+                }
+                mergeRequested = false;
+            }
+            while (pickMerge(plan)) {
+                metrics::ScopedTimer timer(segmentMetrics().mergeDuration);
+                std::shared_ptr<const Segment> merged = mergeSegments(plan.sources);
+                commitMerge(plan, merged);
+            }
+        }
+    }
+
+    // Рівень сегмента: 0 - до flushPostings * mergeFactor записів, 1 - до ще в mergeFactor разів більше...
+    std::size_t tierOf(const SegmentSlot& slot) const {
+        std::size_t tier = 0;
+        std::size_t bound = flushPostings * mergeFactor;
+        while (slot.segment->postingCount >= bound && tier < 32) {
+            bound *= mergeFactor;
+            ++tier;
+        }
+        return tier;
+    }
+
+    bool pickMerge(MergePlan& outPlan) const {
+        auto lock = readLock();
+        outPlan.sources.clear();
+
+        // Сегмент, більшість документів якого видалено, переписується окремо.
+        for (const SegmentSlot& slot : segments) {
+            if (slot.deleted.cardinality() * 2 > slot.segment->docs.cardinality()) {
+                outPlan.sources.push_back(slot);
+                return true;
+            }
+        }
+
+        std::unordered_map<std::size_t, std::vector<std::size_t>> byTier;
+        for (std::size_t i = 0; i < segments.size(); ++i) {
+            std::vector<std::size_t>& tier = byTier[tierOf(segments[i])];
+            tier.push_back(i);
+            if (tier.size() == mergeFactor) {
+                for (std::size_t index : tier) {
+                    outPlan.sources.push_back(segments[index]);
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Злиття без блокування: сегменти незмінні, а видалення взято зі знімка.
+    static std::shared_ptr<const Segment> mergeSegments(const std::vector<SegmentSlot>& sources) {
+        auto merged = std::make_shared<Segment>();
+
+        std::vector<unsigned int> words;
+        for (const SegmentSlot& slot : sources) {
+            words.insert(words.end(), slot.segment->words.begin(), slot.segment->words.end());
+        }
+        std::sort(words.begin(), words.end());
+        words.erase(std::unique(words.begin(), words.end()), words.end());
+
+        std::vector<std::size_t> cursor(sources.size(), 0);
+        for (unsigned int wordId : words) {
+            PostingList docs;
+            for (std::size_t s = 0; s < sources.size(); ++s) {
+                const Segment& segment = *sources[s].segment;
+                std::size_t& pos = cursor[s];
+                if (pos < segment.words.size() && segment.words[pos] == wordId) {
+                    if (sources[s].deleted.empty()) {
+                        docs.uniteWith(segment.postings[pos]);
+                    } else {
+                        docs.uniteWith(PostingList::subtract(segment.postings[pos], sources[s].deleted));
+                    }
+                    ++pos;
+                }
+            }
+            if (docs.empty()) {
+                continue;
+            }
+            docs.shrinkToFit();
+            merged->postingCount += docs.cardinality();
+            merged->words.push_back(wordId);
+            merged->postings.push_back(std::move(docs));
+        }
+
+        for (const SegmentSlot& slot : sources) {
+            merged->docs.uniteWith(PostingList::subtract(slot.segment->docs, slot.deleted));
+        }
+        merged->docs.shrinkToFit();
+        merged->words.shrink_to_fit();
+        merged->postings.shrink_to_fit();
+        return merged;
+    }
+
+    // Джерела замінюються результатом. Видалення, що надійшли під час злиття,
+    // переносяться в мапу видалених нового сегмента. Якщо якогось джерела вже
+    // немає (індекс очистили), результат відкидається.
+    void commitMerge(const MergePlan& plan, const std::shared_ptr<const Segment>& merged) {
+        auto lock = writeLock();
+        auto sourceOf = [&](const SegmentSlot& slot) {
+            return std::find_if(plan.sources.begin(), plan.sources.end(),
+                                [&](const SegmentSlot& s) { return s.segment == slot.segment; });
+        };
+
+        std::size_t found = 0;
+        for (const SegmentSlot& slot : segments) {
+            if (sourceOf(slot) != plan.sources.end()) {
+                ++found;
+            }
+        }
+        if (found != plan.sources.size()) {
+            return;
+        }
+
+        SegmentSlot result;
+        result.segment = merged;
+        std::vector<SegmentSlot> kept;
+        kept.reserve(segments.size() - found + 1);
+        for (SegmentSlot& slot : segments) {
+            auto source = sourceOf(slot);
+            if (source == plan.sources.end()) {
+                kept.push_back(std::move(slot));
+            } else {
+                result.deleted.uniteWith(PostingList::subtract(slot.deleted, source->deleted));
+            }
+        }
+        if (!merged->docs.empty()) {
+            kept.push_back(std::move(result));
+        }
+        segments.swap(kept);
+        segmentMetrics().merges.add();
+        segmentMetrics().segments.set(static_cast<std::int64_t>(segments.size()));
+    }
+
+    struct SegmentMetrics {
+        metrics::Counter&          flushes;
+        metrics::Counter&          merges;
+        metrics::LatencyHistogram& mergeDuration;
+        metrics::Gauge&            segments;
+    };
+
+    static SegmentMetrics& segmentMetrics() {
+        metrics::Registry& r = metrics::registry();
+        static SegmentMetrics m{
+            r.counter("cw_segment_flushes_total", "Mutable segments frozen into immutable ones"),
+            r.counter("cw_segment_merges_total", "Completed background segment merges"),
+            r.histogram("cw_segment_merge_duration_seconds", "Background segment merge latency"),
+            r.gauge("cw_segments", "Immutable segments after the last merge")
+        };
+        return m;
+    }
+
+    std::shared_lock<std::shared_mutex> readLock() const {
+        return metrics::lockShared(mutex, lockMetrics());
+    }
+
+    std::unique_lock<std::shared_mutex> writeLock() const {
+        return metrics::lockExclusive(mutex, lockMetrics());
+    }
+
+    static metrics::LockMetrics& lockMetrics() {
+        static metrics::LockMetrics& lm = metrics::lockMetricsFor("segmented_index");
+        return lm;
+    }
+
+private:
+    std::size_t flushPostings;
+    std::size_t mergeFactor;
+    ThreadPool* pool;
+
+    mutable std::shared_mutex                     mutex;
+    std::unordered_map<unsigned int, PostingList> mutablePostings;
+    PostingList                                   mutableDocs;
+    std::size_t                                   mutablePostingCount;
+    std::vector<FrozenSlot>                       flushing;     // скидання, що ще будуються
+    std::vector<SegmentSlot>                      segments;
+
+    mutable std::mutex              mergeMutex;
+    mutable std::condition_variable mergeDone;
+    bool                            mergeRunning;
+    bool                            mergeRequested;     // новий сегмент з'явився під час злиття
+};
+
+#endif
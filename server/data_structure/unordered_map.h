@@ -3,16 +3,23 @@
 
 #include <unordered_map>
 #include <shared_mutex>
+#include <mutex>
+#include <string>
 #include <cstdint>
 
+#include "metrics.h"
+
 // Проста двостороння таблиця відповідностей:
 //   ID (unsigned int) <-> Value (std::string)
+// lockName - мітка structure у метриках блокувань, щоб різні таблиці
+// (словник, таблиця документів) не зливались в одну серію.
 
 template <typename Value>
 class IdValueTable {
 public:
-    IdValueTable()
+    explicit IdValueTable(const std::string& lockName = "id_value_table")
         : nextId(1)
+        , lockStats(metrics::lockMetricsFor(lockName))
     {}
 
     IdValueTable(const IdValueTable&)            = delete;
@@ -21,7 +28,7 @@ public:
     IdValueTable& operator=(IdValueTable&&)      = delete;
 
     unsigned int add(const Value& value) {
-        std::unique_lock<std::shared_mutex> lock(mutex);
+        auto lock = writeLock();
 
         auto it = valueToId.find(value);
         if (it != valueToId.end()) {
@@ -35,7 +42,7 @@ public:
     }
 
     unsigned int add(Value&& value) {
-        std::unique_lock<std::shared_mutex> lock(mutex);
+        auto lock = writeLock();
 
         auto it = valueToId.find(value);
         if (it != valueToId.end()) {
@@ -48,8 +55,32 @@ public:
         return id;
     }
 
+    // Вставка з уже відомим ID (репліка відтворює ID лідера).
+    // Старі відповідності для цього ID або значення замінюються.
+    void addWithId(unsigned int id, const Value& value) {
+        auto lock = writeLock();
+
+        auto itId = idToValue.find(id);
+        if (itId != idToValue.end()) {
+            if (itId->second == value) {
+                return;
+            }
+            valueToId.erase(itId->second);
+        }
+        auto itValue = valueToId.find(value);
+        if (itValue != valueToId.end()) {
+            idToValue.erase(itValue->second);
+        }
+
+        valueToId[value] = id;
+        idToValue[id]    = value;
+        if (id >= nextId) {
+            nextId = id + 1;
+        }
+    }
+
     bool getId(const Value& value, unsigned int& outId) const {
-        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto lock = readLock();
 
         auto it = valueToId.find(value);
         if (it == valueToId.end()) {
@@ -61,7 +92,7 @@ public:
     }
 
     bool getValue(unsigned int id, Value& outValue) const {
-        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto lock = readLock();
 
         auto it = idToValue.find(id);
         if (it == idToValue.end()) {
@@ -73,17 +104,17 @@ public:
     }
 
     bool hasId(unsigned int id) const {
-        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto lock = readLock();
         return idToValue.find(id) != idToValue.end();
     }
 
     bool hasValue(const Value& value) const {
-        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto lock = readLock();
         return valueToId.find(value) != valueToId.end();
     }
 
     bool removeById(unsigned int id) {
-        std::unique_lock<std::shared_mutex> lock(mutex);
+        auto lock = writeLock();
 
         auto itId = idToValue.find(id);
         if (itId == idToValue.end()) {
@@ -102,7 +133,7 @@ public:
     }
 
     bool removeByValue(const Value& value) {
-        std::unique_lock<std::shared_mutex> lock(mutex);
+        auto lock = writeLock();
 
         auto itValue = valueToId.find(value);
         if (itValue == valueToId.end()) {
@@ -121,22 +152,42 @@ public:
     }
 
     void clear() {
-        std::unique_lock<std::shared_mutex> lock(mutex);
+        auto lock = writeLock();
         idToValue.clear();
         valueToId.clear();
         nextId = 1;
     }
 
+    void copyFrom(const IdValueTable& other) {
+        if (&other == this) {
+            return;
+        }
+        auto otherLock = other.readLock();
+        auto lock      = writeLock();
+        idToValue = other.idToValue;
+        valueToId = other.valueToId;
+        nextId    = other.nextId;
+    }
+
     unsigned int size() const {
-        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto lock = readLock();
         return static_cast<unsigned int>(idToValue.size());
     }
 
 private:
+    std::shared_lock<std::shared_mutex> readLock() const {
+        return metrics::lockShared(mutex, lockStats);
+    }
+
+    std::unique_lock<std::shared_mutex> writeLock() const {
+        return metrics::lockExclusive(mutex, lockStats);
+    }
+
     mutable std::shared_mutex mutex;
     std::unordered_map<unsigned int, Value> idToValue;
     std::unordered_map<Value, unsigned int> valueToId;
     unsigned int nextId;
+    metrics::LockMetrics& lockStats;
 };
 
 #endif
@@ -0,0 +1,155 @@
+#ifndef WORK_STEALING_DEQUE_H
+#define WORK_STEALING_DEQUE_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+// Дек Chase-Lev:
+//   власник робить push/pop з "дна" без блокувань,
+//   інші потоки крадуть (steal) з "верху".
+// T має бути тривіально копійованим (на практиці - вказівник на задачу).
+
+template <typename T>
+class WorkStealingDeque {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "WorkStealingDeque requires a trivially copyable element type");
+
+public:
+    explicit WorkStealingDeque(std::size_t initialCapacity = 256)
+        : top(0)
+        , bottom(0)
+    {
+        std::size_t capacity = 1;
+        while (capacity < initialCapacity) {
+            capacity <<= 1;
+        }
+        buffers.push_back(std::make_unique<Buffer>(static_cast<std::int64_t>(capacity)));
+        buffer.store(buffers.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&)            = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+    WorkStealingDeque(WorkStealingDeque&&)                 = delete;
+    WorkStealingDeque& operator=(WorkStealingDeque&&)      = delete;
+
+    // Тільки потік-власник.
+    void push(T value) {
+        std::int64_t b = bottom.load(std::memory_order_relaxed);
+        std::int64_t t = top.load(std::memory_order_acquire);
+        Buffer* buf = buffer.load(std::memory_order_relaxed);
+
+        if (b - t > buf->capacity - 1) {
+            buf = grow(buf, t, b);
+        }
+
+        buf->put(b, value);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // Тільки потік-власник.
+    bool pop(T& outValue) {
+        std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        Buffer* buf = buffer.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        T value = buf->get(b);
+        if (t == b) {
+            // Останній елемент - змагаємось із крадіями.
+            bool won = top.compare_exchange_strong(t, t + 1,
+                                                   std::memory_order_seq_cst,
+                                                   std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            if (!won) {
+                return false;
+            }
+        }
+
+        outValue = value;
+        return true;
+    }
+
+    // Будь-який потік.
+    bool steal(T& outValue) {
+        std::int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t b = bottom.load(std::memory_order_acquire);
+
+        if (t >= b) {
+            return false;
+        }
+
+        Buffer* buf = buffer.load(std::memory_order_acquire);
+        T value = buf->get(t);
+        if (!top.compare_exchange_strong(t, t + 1,
+                                         std::memory_order_seq_cst,
+                                         std::memory_order_relaxed)) {
+            return false;
+        }
+
+        outValue = value;
+        return true;
+    }
+
+    bool empty() const {
+        return approxSize() == 0;
+    }
+
+    std::size_t approxSize() const {
+        std::int64_t b = bottom.load(std::memory_order_relaxed);
+        std::int64_t t = top.load(std::memory_order_relaxed);
+        return b > t ? static_cast<std::size_t>(b - t) : 0;
+    }
+
+private:
+    struct Buffer {
+        explicit Buffer(std::int64_t cap)
+            : capacity(cap)
+            , mask(cap - 1)
+            , slots(new std::atomic<T>[static_cast<std::size_t>(cap)])
+        {}
+
+        T get(std::int64_t i) const {
+            return slots[static_cast<std::size_t>(i & mask)].load(std::memory_order_relaxed);
+        }
+
+        void put(std::int64_t i, T value) {
+            slots[static_cast<std::size_t>(i & mask)].store(value, std::memory_order_relaxed);
+        }
+
+        std::int64_t                   capacity;
+        std::int64_t                   mask;
+        std::unique_ptr<std::atomic<T>[]> slots;
+    };
+
+    Buffer* grow(Buffer* old, std::int64_t t, std::int64_t b) {
+        // Старі буфери не звільняються до знищення деку:
+        // крадій може ще читати з них.
+        buffers.push_back(std::make_unique<Buffer>(old->capacity * 2));
+        Buffer* bigger = buffers.back().get();
+        for (std::int64_t i = t; i < b; ++i) {
+            bigger->put(i, old->get(i));
+        }
+        buffer.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+
+private:
+    alignas(64) std::atomic<std::int64_t> top;
+    alignas(64) std::atomic<std::int64_t> bottom;
+    alignas(64) std::atomic<Buffer*>      buffer;
+    std::vector<std::unique_ptr<Buffer>>  buffers;
+};
+
+#endif
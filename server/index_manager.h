@@ -7,23 +7,88 @@
 #include <algorithm>
 #include <fstream>
 #include <iterator>
+#include <atomic>
+#include <memory>
+#include <array>
+#include <mutex>
+#include <shared_mutex>
+
+#include "unordered_map.h"
+#include "forward_index.h"
+#include "segmented_index.h"
+#include "doc_path_table.h"
+#include "analyzer.h"
+#include "thread_pool.h"
+#include "posting_ops.h"
+#include "query_parser.h"
+#include "query_planner.h"
+#include "metrics.h"
+#include "mutation_log.h"
+#include "node_replicas.h"
+#include "deadline.h"
+
+// Порядок результатів пошуку: за шляхом (як раніше) або за docId (без сортування).
+enum class ResultOrder {
+    ByPath,
+    ByDocId
+};
 
-#include "IdValueTable.h"
-#include "ForwardIndex.h"
-#include "InvertedIndex.h"
-#include "text_utils.h"
+// Яку частину результатів видати і в якому порядку (LIMIT / OFFSET / ORDER).
+struct ResultWindow {
+    std::size_t offset = 0;
+    std::size_t limit  = static_cast<std::size_t>(-1);
+    ResultOrder order  = ResultOrder::ByPath;
+};
 
 class IndexManager {
 public:
-    IndexManager() = default;
+    IndexManager()
+        : threadPool(nullptr)
+        , mutationLog(nullptr)
+        , segmentFlushPostings(SegmentedIndex::kDefaultFlushPostings)
+        , segmentMergeFactor(SegmentedIndex::kDefaultMergeFactor)
+        , state(std::make_shared<IndexState>())
+    {}
 
     IndexManager(const IndexManager&)            = delete;
     IndexManager& operator=(const IndexManager&) = delete;
     IndexManager(IndexManager&&)                 = delete;
     IndexManager& operator=(IndexManager&&)      = delete;
 
+    // Пул для паралельного виконання одного запиту і фонових злиттів сегментів;
+    // nullptr - послідовно.
+    void setThreadPool(ThreadPool* pool) {
+        threadPool = pool;
+        loadState()->invertedIndex.setMergePool(pool);
+    }
+
+    // Журнал змін для реплік; nullptr - зміни не журналюються.
+    void setMutationLog(MutationLog* log) {
+        mutationLog = log;
+    }
+
+    // Копії словника та інвертованого індексу на кожному NUMA-вузлі: пошук читає
+    // копію свого вузла, поки після її побудови не було змін. На одновузловій
+    // топології нічого не робить. Викликати до початку обслуговування запитів.
+    void enableNodeReplicas(const NumaTopology& topology) {
+        if (!topology.isMultiNode()) {
+            nodeReplicas.reset();
+            return;
+        }
+        nodeReplicas = std::make_unique<NodeReplicas<TermReplica>>(topology, [this](TermReplica& replica) {
+            std::shared_ptr<IndexState> s = loadState();
+            replica.words.copyFrom(s->wordTable);
+            replica.postings.copyFrom(s->invertedIndex);
+        });
+    }
+
+    // Чекає, поки копії всіх вузлів відповідатимуть поточному індексу.
+    bool waitForNodeReplicas(int timeoutMs) const {
+        return nodeReplicas == nullptr || nodeReplicas->waitUntilFresh(timeoutMs);
+    }
+
     bool hasFile(const std::string& docPath, unsigned int& outDocId) const {
-        return docTable.getId(docPath, outDocId);
+        return loadState()->docTable.getId(docPath, outDocId);
     }
 
     bool getFileContent(const std::string& docPath, std::string& outContent) const {
@@ -39,6 +104,7 @@ public:
     }
 
     bool addFile(const std::string& docPath) {
+        metrics::ScopedTimer timer(indexMetrics().add);
         std::string content;
         if (!getFileContent(docPath, content)) {
             return false;
@@ -47,237 +113,749 @@ public:
         return true;
     }
 
+    // Паралельна індексація набору файлів. Повертає кількість доданих.
+    unsigned int addFiles(const std::vector<std::string>& docPaths, ThreadPool& pool) {
+        std::atomic<unsigned int> added(0);
+        pool.parallelFor(0, docPaths.size(), [&](std::size_t lo, std::size_t hi) {
+            for (std::size_t i = lo; i < hi; ++i) {
+                if (addFile(docPaths[i])) {
+                    added.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }, 1);
+        return added.load();
+    }
+
     bool reindexFile(const std::string& docPath) {
+        metrics::ScopedTimer timer(indexMetrics().reindex);
         std::string content;
         if (!getFileContent(docPath, content)) {
             return false;
         }
 
+        std::shared_ptr<IndexState> s = loadState();
         unsigned int docId = 0;
-        if (!docTable.getId(docPath, docId)) {
+        if (!s->docTable.getId(docPath, docId)) {
             addDocumentFromContent(docPath, content);
             return true;
         }
 
-        std::unordered_set<unsigned int> oldWordIds;
-        if (forwardIndex.getWords(docId, oldWordIds)) {
-            for (unsigned int wordId : oldWordIds) {
-                invertedIndex.removePosting(wordId, docId);
-            }
+        DocumentWriteLock lock(*this, docId);
+        if (!ownsPath(s, docId, docPath)) {
+            lock.unlock();
+            addDocumentFromContent(docPath, content);
+            return true;
         }
-
-        forwardIndex.removeDocument(docId);
-
-        addDocumentFromContentWithExistingId(docId, docPath, content);
+        removeDocumentPostings(s, docId);
+        s->forwardIndex.removeDocument(docId);
+        upsertDocumentLocked(s, docId, docPath, content);
 
         return true;
     }
 
     bool removeFile(const std::string& docPath) {
+        metrics::ScopedTimer timer(indexMetrics().remove);
+        std::shared_ptr<IndexState> s = loadState();
         unsigned int docId = 0;
-        if (!docTable.getId(docPath, docId)) {
+        if (!s->docTable.getId(docPath, docId)) {
             return false;
         }
 
-        std::unordered_set<unsigned int> wordIds;
-        if (forwardIndex.getWords(docId, wordIds)) {
-            for (unsigned int wordId : wordIds) {
-                invertedIndex.removePosting(wordId, docId);
-            }
+        DocumentWriteLock lock(*this, docId);
+        if (!ownsPath(s, docId, docPath)) {
+            return false;       // документ уже видалив інший запит
         }
 
-        forwardIndex.removeDocument(docId);
-        docTable.removeByValue(docPath);
-
+        removeDocumentPostings(s, docId);
+        s->forwardIndex.removeDocument(docId);
+        s->docPaths.remove(docId);
+        s->docTable.removeByValue(docPath);
+
+        if (mutationLog != nullptr) {
+            Mutation mutation;
+            mutation.kind    = Mutation::Kind::Remove;
+            mutation.docId   = docId;
+            mutation.docPath = docPath;
+            mutationLog->append(mutation);
+        }
         return true;
     }
 
     void clearAll() {
-        wordTable.clear();
-        docTable.clear();
-        forwardIndex.clear();
-        invertedIndex.clear();
+        std::unique_lock<std::shared_mutex> exclusive(documentsMutex);
+        ReplicaWriteScope scope(nodeReplicas.get());
+        std::shared_ptr<IndexState> s = loadState();
+        s->wordTable.clear();
+        s->docTable.clear();
+        s->docPaths.clear();
+        s->forwardIndex.clear();
+        s->invertedIndex.clear();
+
+        if (mutationLog != nullptr) {
+            Mutation mutation;
+            mutation.kind = Mutation::Kind::Clear;
+            mutationLog->append(mutation);
+        }
     }
 
-    bool searchSingleWord(const std::string& rawWord,
-                          std::vector<std::string>& outDocPaths) const {
-        outDocPaths.clear();
+    // Застосування запису з журналу лідера (на репліці). ID беруться з запису,
+    // повторне застосування того самого запису нічого не змінює.
+    void applyMutation(const Mutation& mutation) {
+        ReplicaWriteScope scope(nodeReplicas.get());
+        std::shared_ptr<IndexState> s = loadState();
+        switch (mutation.kind) {
+        case Mutation::Kind::Clear:
+            s->wordTable.clear();
+            s->docTable.clear();
+            s->docPaths.clear();
+            s->forwardIndex.clear();
+            s->invertedIndex.clear();
+            return;
+
+        case Mutation::Kind::Remove:
+            removeDocumentPostings(s, mutation.docId);
+            s->forwardIndex.removeDocument(mutation.docId);
+            s->docPaths.remove(mutation.docId);
+            s->docTable.removeById(mutation.docId);
+            return;
+
+        case Mutation::Kind::Upsert:
+        default:
+            break;
+        }
 
-        std::string word = rawWord;
-        to_lower_ascii(word);
-        if (word.empty()) {
-            return false;
+        std::unordered_set<unsigned int> wordIdsForDoc;
+        wordIdsForDoc.reserve(mutation.words.size());
+        for (const auto& word : mutation.words) {
+            s->wordTable.addWithId(word.first, word.second);
+            wordIdsForDoc.insert(word.first);
         }
 
-        unsigned int wordId = 0;
-        if (!wordTable.getId(word, wordId)) {
-            return false;
+        removeDocumentPostings(s, mutation.docId);
+        s->docTable.addWithId(mutation.docId, mutation.docPath);
+        s->forwardIndex.setWords(mutation.docId, wordIdsForDoc);
+        s->invertedIndex.addDocument(mutation.docId, wordIdsForDoc);
+        s->docPaths.set(mutation.docId, mutation.docPath);
+    }
+
+    // Порожній IndexManager з тими самими пулом і політикою сегментів - сюди
+    // репліка завантажує знімок, не чіпаючи індекс, що обслуговує запити.
+    std::unique_ptr<IndexManager> makeStaging() const {
+        auto staging = std::make_unique<IndexManager>();
+        staging->setThreadPool(threadPool);
+        staging->setSegmentPolicy(segmentFlushPostings, segmentMergeFactor);
+        return staging;
+    }
+
+    // Підміняє весь стан індексу завантаженим у staged (той лишається порожнім).
+    // Лише для репліки: інших писачів, що тримають старий стан, бути не повинно.
+    void adoptState(IndexManager& staged) {
+        std::shared_ptr<IndexState> next = std::atomic_exchange(&staged.state, staged.makeState());
+        std::shared_ptr<IndexState> previous;
+        {
+            std::unique_lock<std::shared_mutex> exclusive(documentsMutex);
+            ReplicaWriteScope scope(nodeReplicas.get());
+            previous = std::atomic_exchange(&state, next);
         }
+        // Старий стан звільнить останній запит, що його тримає; фонове злиття
+        // в ньому має завершитися тут, а не в деструкторі на потоці пулу.
+        previous->invertedIndex.waitForMerges();
+    }
+
+    // Знімок для нової репліки: visit(const Mutation&) для кожного документа.
+    // Документи, змінені під час обходу, потрапляють у знімок у новішому стані -
+    // репліка однаково отримає ці зміни з журналу і застосує їх повторно.
+    template <typename Visitor>
+    void forEachDocument(Visitor&& visit) const {
+        std::shared_ptr<IndexState> s = loadState();
+        PostingList docIds;
+        s->forwardIndex.getDocumentIds(docIds);
 
-        std::unordered_set<unsigned int> docIds;
-        if (!invertedIndex.getDocuments(wordId, docIds)) {
+        Mutation mutation;
+        std::unordered_set<unsigned int> wordIds;
+        docIds.forEach([&](unsigned int docId) {
+            {
+                DocPathTable::ReadGuard guard(s->docPaths);
+                const std::string* path = guard.get(docId);
+                if (path == nullptr || !s->forwardIndex.getWords(docId, wordIds)) {
+                    return;
+                }
+                mutation.docPath = *path;
+            }
+            mutation.kind  = Mutation::Kind::Upsert;
+            mutation.docId = docId;
+            mutation.words.clear();
+            for (unsigned int wordId : wordIds) {
+                std::string word;
+                if (s->wordTable.getValue(wordId, word)) {
+                    mutation.words.emplace_back(wordId, std::move(word));
+                }
+            }
+            visit(mutation);
+        });
+    }
+
+    // find*: якщо deadline вийшов під час пошуку, результат порожній і повертається
+    // false; викликач розрізняє "нічого не знайдено" і тайм-аут через deadline.expired().
+    bool findSingleWord(const std::string& rawWord,
+                        std::vector<unsigned int>& outDocIds,
+                        const Deadline& deadline = Deadline()) const {
+        metrics::ScopedTimer timer(indexMetrics().searchSingle);
+        outDocIds.clear();
+
+        // "foo-bar" дає два терми, і документ має містити обидва.
+        TermView view = termView();
+        std::vector<unsigned int> wordIds;
+        if (!lookupAllTerms(view, rawWord, wordIds) || wordIds.empty()) {
             return false;
         }
 
-        outDocPaths.reserve(docIds.size());
-        for (unsigned int docId : docIds) {
-            std::string path;
-            if (docTable.getValue(docId, path)) {
-                outDocPaths.push_back(path);
-            }
+        PostingList docIds;
+        bool found = wordIds.size() == 1 ? view.postings->getDocuments(wordIds.front(), docIds)
+                                         : view.postings->intersectDocuments(wordIds, docIds, &deadline);
+        if (!found || deadline.expired()) {
+            return false;
         }
 
-        std::sort(outDocPaths.begin(), outDocPaths.end());
-        return !outDocPaths.empty();
+        docIds.toVector(outDocIds);
+        return !outDocIds.empty();
     }
 
-    bool searchAllWords(const std::vector<std::string>& rawWords,
-                        std::vector<std::string>& outDocPaths) const {
-        outDocPaths.clear();
+    bool findAllWords(const std::vector<std::string>& rawWords,
+                      std::vector<unsigned int>& outDocIds,
+                      const Deadline& deadline = Deadline()) const {
+        metrics::ScopedTimer timer(indexMetrics().searchAll);
+        outDocIds.clear();
         if (rawWords.empty()) {
             return false;
         }
 
-        bool first = true;
-        std::unordered_set<unsigned int> resultDocIds;
+        TermView view = termView();
+        std::vector<unsigned int> wordIds;
+        wordIds.reserve(rawWords.size());
 
         for (const std::string& rawWord : rawWords) {
-            std::string word = rawWord;
-            to_lower_ascii(word);
-            if (word.empty()) {
-                continue;
-            }
-
-            unsigned int wordId = 0;
-            if (!wordTable.getId(word, wordId)) {
-                resultDocIds.clear();
+            if (!lookupAllTerms(view, rawWord, wordIds)) {
                 return false;
             }
+        }
 
-            std::unordered_set<unsigned int> docIdsForWord;
-            if (!invertedIndex.getDocuments(wordId, docIdsForWord)) {
-                resultDocIds.clear();
-                return false;
+        // Перетин рахується в кожному сегменті індексу окремо.
+        PostingList resultDocIds;
+        if (!view.postings->intersectDocuments(wordIds, resultDocIds, &deadline) || deadline.expired()) {
+            return false;
+        }
+
+        resultDocIds.toVector(outDocIds);
+        return !outDocIds.empty();
+    }
+
+    bool findAnyWord(const std::vector<std::string>& rawWords,
+                     std::vector<unsigned int>& outDocIds,
+                     const Deadline& deadline = Deadline()) const {
+        metrics::ScopedTimer timer(indexMetrics().searchAny);
+        outDocIds.clear();
+
+        // Кожне слово - група термів через AND (зазвичай з одного терма).
+        TermView view = termView();
+        std::vector<std::vector<unsigned int>> groups;
+        for (const std::string& rawWord : rawWords) {
+            std::vector<unsigned int> wordIds;
+            if (lookupAllTerms(view, rawWord, wordIds) && !wordIds.empty()) {
+                groups.push_back(std::move(wordIds));
             }
+        }
 
-            if (first) {
-                resultDocIds = std::move(docIdsForWord);
-                first = false;
-            } else {
-                std::unordered_set<unsigned int> intersection;
-                for (unsigned int docId : resultDocIds) {
-                    if (docIdsForWord.find(docId) != docIdsForWord.end()) {
-                        intersection.insert(docId);
-                    }
-                }
-                resultDocIds.swap(intersection);
+        std::sort(groups.begin(), groups.end());
+        groups.erase(std::unique(groups.begin(), groups.end()), groups.end());
 
-                if (resultDocIds.empty()) {
-                    return false;
+        std::vector<PostingList> postings(groups.size());
+        auto loadPostings = [&](std::size_t lo, std::size_t hi) {
+            for (std::size_t i = lo; i < hi && !deadline.expired(); ++i) {
+                if (groups[i].size() == 1) {
+                    view.postings->getDocuments(groups[i].front(), postings[i]);
+                } else {
+                    view.postings->intersectDocuments(groups[i], postings[i], &deadline);
                 }
             }
+        };
+        if (threadPool != nullptr && groups.size() > 1) {
+            threadPool->parallelFor(0, groups.size(), loadPostings, 1);
+        } else {
+            loadPostings(0, groups.size());
+        }
+
+        posting_ops::PostingRefs lists;
+        lists.reserve(postings.size());
+        for (const PostingList& posting : postings) {
+            if (!posting.empty()) {
+                lists.push_back(&posting);
+            }
         }
 
-        if (resultDocIds.empty()) {
+        if (deadline.expired()) {
             return false;
         }
+        posting_ops::unionPostings(lists, outDocIds, threadPool, &deadline);
+        if (deadline.expired()) {
+            outDocIds.clear();
+        }
+        return !outDocIds.empty();
+    }
+
+    // Булевий запит: (a OR b) AND c AND NOT d
+    bool findQuery(const std::string& expression,
+                   std::vector<unsigned int>& outDocIds,
+                   std::string& outError,
+                   const Deadline& deadline = Deadline()) const {
+        metrics::ScopedTimer timer(indexMetrics().searchQuery);
+        outDocIds.clear();
+        outError.clear();
+
+        std::unique_ptr<QueryNode> root;
+        QueryParser parser;
+        if (!parser.parse(expression, root, outError)) {
+            return false;
+        }
+        root = analyzeQuery(std::move(root));
+        if (!root) {
+            outError = "Query has no searchable terms";
+            return false;
+        }
+
+        QuerySource source(*this);
+        QueryPlanner<QuerySource> planner(source, threadPool, &deadline);
+        std::unique_ptr<PlanNode> plan = planner.plan(*root);
+
+        PostingList resultDocIds;
+        planner.execute(*plan, resultDocIds);
+        if (deadline.expired()) {
+            return false;
+        }
+        resultDocIds.toVector(outDocIds);
+        return !outDocIds.empty();
+    }
 
-        outDocPaths.reserve(resultDocIds.size());
-        for (unsigned int docId : resultDocIds) {
-            std::string path;
-            if (docTable.getValue(docId, path)) {
-                outDocPaths.push_back(path);
+    // Перетворює відсортовані docId на шляхи без копіювання рядків:
+    // sink.begin(count) викликається один раз, далі sink.path(path) для кожного
+    // результату з вікна [offset, offset + limit). Повертає кількість виданих шляхів.
+    template <typename Sink>
+    std::size_t materialize(const std::vector<unsigned int>& docIds,
+                            const ResultWindow& window,
+                            Sink& sink) const {
+        metrics::ScopedTimer timer(indexMetrics().materialize);
+        std::shared_ptr<IndexState> s = loadState();
+        DocPathTable::ReadGuard guard(s->docPaths);
+
+        std::vector<const std::string*> paths;
+        paths.reserve(docIds.size());
+        for (unsigned int docId : docIds) {
+            const std::string* path = guard.get(docId);
+            if (path != nullptr) {
+                paths.push_back(path);
+            }
+        }
+
+        std::size_t first = std::min(window.offset, paths.size());
+        std::size_t last  = paths.size() - first > window.limit ? first + window.limit : paths.size();
+
+        if (window.order == ResultOrder::ByPath && first < last) {
+            auto byPath = [](const std::string* lhs, const std::string* rhs) { return *lhs < *rhs; };
+            if (last < paths.size()) {
+                // Потрібна лише сторінка - досить часткового сортування.
+                std::nth_element(paths.begin(), paths.begin() + static_cast<std::ptrdiff_t>(first),
+                                 paths.end(), byPath);
+                std::partial_sort(paths.begin() + static_cast<std::ptrdiff_t>(first),
+                                  paths.begin() + static_cast<std::ptrdiff_t>(last),
+                                  paths.end(), byPath);
+            } else {
+                posting_ops::parallelSort(paths, threadPool, byPath);
             }
         }
 
-        std::sort(outDocPaths.begin(), outDocPaths.end());
-        return !outDocPaths.empty();
+        indexMetrics().results.add(last - first);
+        sink.begin(last - first);
+        for (std::size_t i = first; i < last; ++i) {
+            sink.path(*paths[i]);
+        }
+        return last - first;
+    }
+
+    bool searchSingleWord(const std::string& rawWord,
+                          std::vector<std::string>& outDocPaths,
+                          const ResultWindow& window = ResultWindow()) const {
+        std::vector<unsigned int> docIds;
+        findSingleWord(rawWord, docIds);
+        return collectPaths(docIds, window, outDocPaths);
+    }
+
+    bool searchAllWords(const std::vector<std::string>& rawWords,
+                        std::vector<std::string>& outDocPaths,
+                        const ResultWindow& window = ResultWindow()) const {
+        std::vector<unsigned int> docIds;
+        findAllWords(rawWords, docIds);
+        return collectPaths(docIds, window, outDocPaths);
     }
 
     bool searchAnyWord(const std::vector<std::string>& rawWords,
-                       std::vector<std::string>& outDocPaths) const {
-        outDocPaths.clear();
+                       std::vector<std::string>& outDocPaths,
+                       const ResultWindow& window = ResultWindow()) const {
+        std::vector<unsigned int> docIds;
+        findAnyWord(rawWords, docIds);
+        return collectPaths(docIds, window, outDocPaths);
+    }
 
-        std::unordered_set<unsigned int> resultDocIds;
+    bool searchQuery(const std::string& expression,
+                     std::vector<std::string>& outDocPaths,
+                     std::string& outError,
+                     const ResultWindow& window = ResultWindow()) const {
+        std::vector<unsigned int> docIds;
+        findQuery(expression, docIds, outError);
+        return collectPaths(docIds, window, outDocPaths);
+    }
 
-        for (const std::string& rawWord : rawWords) {
-            std::string word = rawWord;
-            to_lower_ascii(word);
-            if (word.empty()) {
-                continue;
-            }
+    unsigned int wordCount() const {
+        return loadState()->wordTable.size();
+    }
 
-            unsigned int wordId = 0;
-            if (!wordTable.getId(word, wordId)) {
-                continue;
+    unsigned int documentCount() const {
+        return loadState()->docTable.size();
+    }
+
+    std::size_t postingMemoryUsage() const {
+        return loadState()->invertedIndex.memoryUsage();
+    }
+
+    std::size_t segmentCount() const {
+        return loadState()->invertedIndex.segmentCount();
+    }
+
+    // Розмір змінного сегмента (у записах) і кратність злиття рівнів.
+    void setSegmentPolicy(std::size_t flushPostings, std::size_t mergeFactor) {
+        segmentFlushPostings = flushPostings;
+        segmentMergeFactor   = mergeFactor;
+        loadState()->invertedIndex.setMergePolicy(flushPostings, mergeFactor);
+    }
+
+    // Чекає завершення фонових злиттів сегментів.
+    void waitForMerges() const {
+        loadState()->invertedIndex.waitForMerges();
+    }
+
+    // Пакетний пошук: кожен запит виконується окремою задачею пулу.
+    void searchBatch(const std::vector<std::vector<std::string>>& queries,
+                     bool matchAll,
+                     std::vector<std::vector<std::string>>& outResults,
+                     ThreadPool& pool) const {
+        outResults.assign(queries.size(), std::vector<std::string>());
+        pool.parallelFor(0, queries.size(), [&](std::size_t lo, std::size_t hi) {
+            for (std::size_t i = lo; i < hi; ++i) {
+                if (matchAll) {
+                    searchAllWords(queries[i], outResults[i]);
+                } else {
+                    searchAnyWord(queries[i], outResults[i]);
+                }
             }
+        }, 1);
+    }
 
-            std::unordered_set<unsigned int> docIdsForWord;
-            if (!invertedIndex.getDocuments(wordId, docIdsForWord)) {
-                continue;
+private:
+    struct IndexMetrics {
+        metrics::LatencyHistogram& add;
+        metrics::LatencyHistogram& reindex;
+        metrics::LatencyHistogram& remove;
+        metrics::LatencyHistogram& searchSingle;
+        metrics::LatencyHistogram& searchAll;
+        metrics::LatencyHistogram& searchAny;
+        metrics::LatencyHistogram& searchQuery;
+        metrics::LatencyHistogram& materialize;
+        metrics::Counter&          results;
+    };
+
+    static IndexMetrics& indexMetrics() {
+        static const char* kUpdateHelp = "IndexManager update latency";
+        static const char* kSearchHelp = "IndexManager search latency (docId stage)";
+        metrics::Registry& r = metrics::registry();
+        static IndexMetrics m{
+            r.histogram("cw_index_update_duration_seconds", kUpdateHelp, "op=\"add\""),
+            r.histogram("cw_index_update_duration_seconds", kUpdateHelp, "op=\"reindex\""),
+            r.histogram("cw_index_update_duration_seconds", kUpdateHelp, "op=\"remove\""),
+            r.histogram("cw_index_search_duration_seconds", kSearchHelp, "op=\"single\""),
+            r.histogram("cw_index_search_duration_seconds", kSearchHelp, "op=\"all\""),
+            r.histogram("cw_index_search_duration_seconds", kSearchHelp, "op=\"any\""),
+            r.histogram("cw_index_search_duration_seconds", kSearchHelp, "op=\"query\""),
+            r.histogram("cw_index_materialize_duration_seconds", "docId to path materialization latency"),
+            r.counter("cw_index_results_total", "Paths returned to clients")
+        };
+        return m;
+    }
+
+    // Дані індексу за одним вказівником: репліка завантажує знімок лідера в
+    // окремий IndexManager і підміняє стан цілком (adoptState), тож запити не
+    // бачать напівзавантажений індекс. Запит тримає свій стан до кінця.
+    struct IndexState {
+        IndexState()
+            : wordTable("word_table")
+            , docTable("doc_table")
+        {}
+
+        IdValueTable<std::string> wordTable;
+        IdValueTable<std::string> docTable;
+        DocPathTable              docPaths;
+        ForwardIndex              forwardIndex;
+        SegmentedIndex            invertedIndex;
+    };
+
+    // Словник і постинги, з яких читає один запит: копія вузла поточного потоку
+    // (replica тримає її живою до кінця запиту) або первинні структури.
+    struct TermReplica {
+        TermReplica()
+            : words("word_table_replica")
+        {}
+
+        IdValueTable<std::string> words;
+        SegmentedIndex            postings;
+    };
+
+    struct TermView {
+        std::shared_ptr<const IndexState>  state;
+        std::shared_ptr<const TermReplica> replica;
+        const IdValueTable<std::string>*   words    = nullptr;
+        const SegmentedIndex*              postings = nullptr;
+    };
+
+    typedef NodeReplicas<TermReplica>::WriteScope ReplicaWriteScope;
+
+    TermView termView() const {
+        TermView view;
+        view.state = loadState();
+        if (nodeReplicas != nullptr) {
+            view.replica = nodeReplicas->local();
+        }
+        view.words    = view.replica ? &view.replica->words : &view.state->wordTable;
+        view.postings = view.replica ? &view.replica->postings : &view.state->invertedIndex;
+        return view;
+    }
+
+    // Джерело списків документів для планувальника запитів.
+    class QuerySource {
+    public:
+        explicit QuerySource(const IndexManager& owner)
+            : view(owner.termView())
+        {}
+
+        // Терм уже пройшов аналізатор (analyzeQuery).
+        bool lookupTerm(const std::string& term, unsigned int& outWordId, std::size_t& outCount) const {
+            if (!view.words->getId(term, outWordId)) {
+                return false;
             }
+            outCount = view.postings->getCardinality(outWordId);
+            return true;
+        }
 
-            resultDocIds.insert(docIdsForWord.begin(), docIdsForWord.end());
+        void fetchTerm(unsigned int wordId, PostingList& out) const {
+            view.postings->getDocuments(wordId, out);
         }
 
-        if (resultDocIds.empty()) {
-            return false;
+        void fetchAll(PostingList& out) const {
+            view.state->forwardIndex.getDocumentIds(out);
         }
 
-        outDocPaths.reserve(resultDocIds.size());
-        for (unsigned int docId : resultDocIds) {
-            std::string path;
-            if (docTable.getValue(docId, path)) {
-                outDocPaths.push_back(path);
+        std::size_t documentCount() const {
+            return view.state->forwardIndex.size();
+        }
+
+    private:
+        TermView view;
+    };
+
+    // Додає до outWordIds ID усіх термів слова. false, якщо якогось терма немає в
+    // індексі; слово без термів (стоп-слово, пунктуація) нічого не додає.
+    static bool lookupAllTerms(const TermView& view,
+                               const std::string& rawWord,
+                               std::vector<unsigned int>& outWordIds) {
+        bool known = true;
+        analysis::DefaultAnalyzer::analyze(rawWord, [&](const std::string& term) {
+            unsigned int wordId = 0;
+            if (!known || !view.words->getId(term, wordId)) {
+                known = false;
+                return;
+            }
+            outWordIds.push_back(wordId);
+        });
+        return known;
+    }
+
+    // Терми запиту проходять той самий аналізатор, що й документи. Слово з
+    // кількох термів стає їх AND; слово без термів нейтральне й випадає з
+    // AND/OR/NOT. nullptr, якщо від виразу нічого не лишилось.
+    static std::unique_ptr<QueryNode> analyzeQuery(std::unique_ptr<QueryNode> node) {
+        if (node->kind == QueryNode::Kind::Term) {
+            std::vector<std::string> terms = analysis::DefaultAnalyzer::terms(node->term);
+            if (terms.empty()) {
+                return nullptr;
+            }
+            if (terms.size() == 1) {
+                node->term = std::move(terms.front());
+                return node;
+            }
+            auto conjunction = std::make_unique<QueryNode>(QueryNode::Kind::And);
+            for (std::string& term : terms) {
+                auto leaf = std::make_unique<QueryNode>(QueryNode::Kind::Term);
+                leaf->term = std::move(term);
+                conjunction->children.push_back(std::move(leaf));
             }
+            return conjunction;
         }
 
-        std::sort(outDocPaths.begin(), outDocPaths.end());
-        return !outDocPaths.empty();
+        std::vector<std::unique_ptr<QueryNode>> kept;
+        for (auto& child : node->children) {
+            std::unique_ptr<QueryNode> analyzed = analyzeQuery(std::move(child));
+            if (analyzed) {
+                kept.push_back(std::move(analyzed));
+            }
+        }
+        if (kept.empty()) {
+            return nullptr;
+        }
+        if (kept.size() == 1 && node->kind != QueryNode::Kind::Not) {
+            return std::move(kept.front());
+        }
+        node->children = std::move(kept);
+        return node;
+    }
+
+    bool collectPaths(const std::vector<unsigned int>& docIds,
+                      const ResultWindow& window,
+                      std::vector<std::string>& outDocPaths) const {
+        struct VectorSink {
+            std::vector<std::string>& out;
+
+            void begin(std::size_t count) {
+                out.clear();
+                out.reserve(count);
+            }
+
+            void path(const std::string& p) {
+                out.push_back(p);
+            }
+        };
+
+        VectorSink sink{outDocPaths};
+        return materialize(docIds, window, sink) > 0;
     }
 
 private:
+    std::shared_ptr<IndexState> loadState() const {
+        return std::atomic_load(&state);
+    }
+
+    std::shared_ptr<IndexState> makeState() const {
+        auto fresh = std::make_shared<IndexState>();
+        fresh->invertedIndex.setMergePool(threadPool);
+        fresh->invertedIndex.setMergePolicy(segmentFlushPostings, segmentMergeFactor);
+        return fresh;
+    }
+
     unsigned int addDocumentFromContent(const std::string& docPath,
                                         const std::string& content) {
-        unsigned int docId = 0;
-        if (!docTable.getId(docPath, docId)) {
-            docId = docTable.add(docPath);
+        std::shared_ptr<IndexState> s = loadState();
+        for (;;) {
+            unsigned int docId = 0;
+            if (!s->docTable.getId(docPath, docId)) {
+                docId = s->docTable.add(docPath);
+            }
+
+            DocumentWriteLock lock(*this, docId);
+            if (ownsPath(s, docId, docPath)) {
+                upsertDocumentLocked(s, docId, docPath, content);
+                return docId;
+            }
+            // Шлях видалили між призначенням ID і замком - ID призначається знову.
         }
+    }
 
-        addDocumentFromContentWithExistingId(docId, docPath, content);
-        return docId;
+    static bool ownsPath(const std::shared_ptr<IndexState>& s, unsigned int docId, const std::string& docPath) {
+        unsigned int currentId = 0;
+        return s->docTable.getId(docPath, currentId) && currentId == docId;
     }
 
-    void addDocumentFromContentWithExistingId(unsigned int docId,
-                                              const std::string& docPath,
-                                              const std::string& content) {
-        std::string tmp = content;
-        to_lower_ascii(tmp);
-        std::vector<std::string> tokens = split_to_words_ascii(tmp);
+    void removeDocumentPostings(const std::shared_ptr<IndexState>& s, unsigned int docId) {
+        ReplicaWriteScope scope(nodeReplicas.get());
+        std::unordered_set<unsigned int> wordIds;
+        s->forwardIndex.getWords(docId, wordIds);
+        s->invertedIndex.removeDocument(docId, wordIds);
+    }
 
+    // Зміна документа та її запис у журнал під одним замком документа: журнал
+    // бачить зміни одного docId в тому самому порядку, в якому їх застосовано.
+    void upsertDocumentLocked(const std::shared_ptr<IndexState>& s,
+                              unsigned int docId,
+                              const std::string& docPath,
+                              const std::string& content) {
+        ReplicaWriteScope scope(nodeReplicas.get());
         std::unordered_set<unsigned int> wordIdsForDoc;
-        wordIdsForDoc.reserve(tokens.size());
+        wordIdsForDoc.reserve(content.size() / 8);
 
-        for (const std::string& token : tokens) {
-            if (token.empty()) {
-                continue;
+        Mutation mutation;
+        analysis::DefaultAnalyzer::analyze(content, [&](const std::string& term) {
+            unsigned int wordId = s->wordTable.add(term);
+            if (wordIdsForDoc.insert(wordId).second && mutationLog != nullptr) {
+                mutation.words.emplace_back(wordId, term);
             }
-            unsigned int wordId = wordTable.add(token);
-            wordIdsForDoc.insert(wordId);
-        }
+        });
+
+        s->forwardIndex.setWords(docId, wordIdsForDoc);
+
+        s->invertedIndex.addDocument(docId, wordIdsForDoc);
 
-        forwardIndex.setWords(docId, wordIdsForDoc);
+        s->docPaths.set(docId, docPath);
 
-        for (unsigned int wordId : wordIdsForDoc) {
-            invertedIndex.addPosting(wordId, docId);
+        if (mutationLog != nullptr) {
+            mutation.kind    = Mutation::Kind::Upsert;
+            mutation.docId   = docId;
+            mutation.docPath = docPath;
+            mutationLog->append(mutation);
         }
     }
 
-private:
-    IdValueTable<std::string> wordTable;
-    IdValueTable<std::string> docTable;
-    ForwardIndex              forwardIndex;
-    InvertedIndex             invertedIndex;
+    ThreadPool*                 threadPool;
+    MutationLog*                mutationLog;
+    std::size_t                 segmentFlushPostings;
+    std::size_t                 segmentMergeFactor;
+    std::shared_ptr<IndexState> state;
+
+    // Смуги замків за docId: зміни різних документів комутують, тож їм достатньо
+    // впорядкування в межах документа. Зміни документів тримають documentsMutex
+    // спільно, clearAll і adoptState - ексклюзивно.
+    static constexpr std::size_t kDocumentLockStripes = 64;
+    mutable std::shared_mutex                            documentsMutex;
+    mutable std::array<std::mutex, kDocumentLockStripes> documentLocks;
+
+    class DocumentWriteLock {
+    public:
+        DocumentWriteLock(const IndexManager& owner, unsigned int docId)
+            : shared(owner.documentsMutex)
+            , stripe(owner.documentLocks[docId % kDocumentLockStripes])
+        {}
+
+        DocumentWriteLock(const DocumentWriteLock&)            = delete;
+        DocumentWriteLock& operator=(const DocumentWriteLock&) = delete;
+        DocumentWriteLock(DocumentWriteLock&&)                 = delete;
+        DocumentWriteLock& operator=(DocumentWriteLock&&)      = delete;
+
+        void unlock() {
+            stripe.unlock();
+            shared.unlock();
+        }
+
+    private:
+        std::shared_lock<std::shared_mutex> shared;
+        std::unique_lock<std::mutex>        stripe;
+    };
+
+    // Останнє поле: руйнується першим і зупиняє потоки, що копіюють поля вище.
+    std::unique_ptr<NodeReplicas<TermReplica>> nodeReplicas;
 };
 
 #endif
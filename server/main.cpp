@@ -1,41 +1,235 @@
+#include <cstdlib>
+#include <filesystem>
 #include <iostream>
-#include <thread>
+#include <memory>
+#include <string>
 #include <vector>
-#include "concurrent_queue.h"
 
-int main() {
-    ConcurrentQueue<int> q;
+#include "server.h"
 
-    std::thread producer1([&]() {
-        for (int i = 0; i < 50; ++i) {
-            q.push(i);
-        }
-    });
+// Запуск сервера:
+//   CW [--ip IP] [--port PORT] [--threads N] [PATH...]
+// Кожен PATH - файл або каталог (рекурсивно), які індексуються до старту.
+//
+// Кластер: шарди - звичайні сервери, координатор запускається з
+//   CW --port 8080 --coordinator 127.0.0.1:9001,127.0.0.1:9002 [--shard-timeout MS] [PATH...]
+// і розподіляє PATH між шардами за хешем шляху.
+//
+// Реплікація: лідер журналює зміни й віддає їх фоловерам,
+//   CW --port 8080 --leader [--log-capacity N] [PATH...]
+//   CW --port 8081 --follow 127.0.0.1:8080
+// Фоловер отримує знімок, далі застосовує журнал і обслуговує лише пошук.
+//
+// NUMA: --pin node|cpu закріплює робочі потоки за вузлами (або окремими CPU),
+// --io-cpus LIST - потік accept() за вказаними CPU, --numa-replicas тримає копію
+// словника й постингів на кожному вузлі. --numa-emulate N ділить CPU на N штучних
+// вузлів (перевірка на одновузловій машині). На одному вузлі все це no-op.
+//
+// Перевантаження: --max-in-flight N обмежує прийняті й ще не оброблені з'єднання
+// (решта отримує ERROR BUSY), --request-timeout MS - термін запиту від accept()
+// (після нього ERROR TIMEOUT). 0 вимикає відповідне обмеження.
+//
+// Сегменти індексу: --segment-postings N - скільки записів набирає змінний
+// сегмент, перш ніж стати незмінним (злиття йдуть у фоні на пулі).
+
+namespace {
 
-    std::thread producer2([&]() {
-        for (int i = 100; i < 150; ++i) {
-            q.push(i);
+void printUsage() {
+    std::cout << "Usage: CW [--ip IP] [--port PORT] [--threads N]\n"
+              << "          [--coordinator HOST:PORT,...] [--shard-timeout MS]\n"
+              << "          [--leader [--log-capacity N] | --follow HOST:PORT]\n"
+              << "          [--max-in-flight N] [--request-timeout MS] [--segment-postings N]\n"
+              << "          [--pin none|node|cpu] [--io-cpus LIST] [--numa-replicas] [--numa-emulate N] [PATH...]\n";
+}
+
+void collectFiles(const std::string& path, std::vector<std::string>& outFiles) {
+    std::error_code ec;
+    if (std::filesystem::is_regular_file(path, ec)) {
+        outFiles.push_back(path);
+        return;
+    }
+    if (!std::filesystem::is_directory(path, ec)) {
+        std::cerr << "Skipping " << path << ": not a file or directory\n";
+        return;
+    }
+    for (auto it = std::filesystem::recursive_directory_iterator(path, ec);
+         it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+        if (ec) {
+            break;
+        }
+        if (it->is_regular_file(ec)) {
+            outFiles.push_back(it->path().string());
         }
-    });
+    }
+}
 
-    std::thread consumer([&]() {
-        int value;
-        for (;;) {
-            if (q.try_pop(value)) {
-                std::cout << "Got: " << value << "\n";
-            } else {
-                std::this_thread::yield();
-            }
+} // namespace
 
-            if (q.empty()) {
+int main(int argc, char** argv) {
+    std::string  ip      = "127.0.0.1";
+    int          port    = 8080;
+    unsigned int threads = 0;
+    std::string  shardList;
+    int          shardTimeoutMs = 2000;
+    bool         leader         = false;
+    std::size_t  logCapacity    = 1 << 16;
+    std::string  followAddress;
+    WorkerPinning pinning       = WorkerPinning::None;
+    std::string  ioCpus;
+    bool         numaReplicas   = false;
+    unsigned int numaEmulate    = 0;
+    std::size_t  maxInFlight    = 1024;
+    int          requestTimeout = 5000;
+    std::size_t  segmentPostings = SegmentedIndex::kDefaultFlushPostings;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool needsValue = arg == "--ip" || arg == "--port" || arg == "--threads"
+                       || arg == "--coordinator" || arg == "--shard-timeout"
+                       || arg == "--log-capacity" || arg == "--follow"
+                       || arg == "--pin" || arg == "--io-cpus" || arg == "--numa-emulate"
+                       || arg == "--max-in-flight" || arg == "--request-timeout"
+                       || arg == "--segment-postings";
+        if (needsValue && i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return 2;
+        }
+        if (arg == "--ip") {
+            ip = argv[++i];
+        } else if (arg == "--port") {
+            port = std::atoi(argv[++i]);
+        } else if (arg == "--threads") {
+            threads = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--coordinator") {
+            shardList = argv[++i];
+        } else if (arg == "--shard-timeout") {
+            shardTimeoutMs = std::atoi(argv[++i]);
+        } else if (arg == "--leader") {
+            leader = true;
+        } else if (arg == "--log-capacity") {
+            logCapacity = static_cast<std::size_t>(std::strtoull(argv[++i], nullptr, 10));
+        } else if (arg == "--follow") {
+            followAddress = argv[++i];
+        } else if (arg == "--pin") {
+            std::string mode = argv[++i];
+            if (mode == "none") {
+                pinning = WorkerPinning::None;
+            } else if (mode == "node") {
+                pinning = WorkerPinning::Node;
+            } else if (mode == "cpu") {
+                pinning = WorkerPinning::Cpu;
+            } else {
+                std::cerr << "Invalid value for --pin: " << mode << "\n";
+                return 2;
             }
+        } else if (arg == "--io-cpus") {
+            ioCpus = argv[++i];
+        } else if (arg == "--numa-replicas") {
+            numaReplicas = true;
+        } else if (arg == "--numa-emulate") {
+            numaEmulate = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--max-in-flight") {
+            maxInFlight = static_cast<std::size_t>(std::strtoull(argv[++i], nullptr, 10));
+        } else if (arg == "--request-timeout") {
+            requestTimeout = std::atoi(argv[++i]);
+        } else if (arg == "--segment-postings") {
+            segmentPostings = static_cast<std::size_t>(std::strtoull(argv[++i], nullptr, 10));
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        } else {
+            paths.push_back(arg);
         }
-    });
+    }
+
+    if (!Server::initSockets()) {
+        return 1;
+    }
+
+    std::vector<ShardEndpoint> shards;
+    std::vector<ShardEndpoint> leaderEndpoint;
+    std::string error;
+    if ((!shardList.empty() && !ShardCoordinator::parseEndpoints(shardList, shards, error))
+        || (!followAddress.empty() && !ShardCoordinator::parseEndpoints(followAddress, leaderEndpoint, error))) {
+        std::cerr << error << "\n";
+        Server::cleanupSockets();
+        return 2;
+    }
+    if (static_cast<int>(!shards.empty()) + static_cast<int>(leader) + static_cast<int>(!leaderEndpoint.empty()) > 1) {
+        std::cerr << "--coordinator, --leader and --follow are mutually exclusive\n";
+        Server::cleanupSockets();
+        return 2;
+    }
+
+    // Журнал оголошено до сервера: він має пережити задачі пулу, що в нього пишуть.
+    MutationLog mutationLog(logCapacity);
+    NumaTopology topology = numaEmulate > 0 ? NumaTopology::emulated(numaEmulate) : NumaTopology::system();
+    Server server(threads, pinning, topology);
+    server.setAdmissionLimits(maxInFlight, requestTimeout);
+    server.getIndexManager().setSegmentPolicy(segmentPostings, SegmentedIndex::kDefaultMergeFactor);
+    if (numaReplicas) {
+        server.getIndexManager().enableNodeReplicas(topology);
+    }
+    if (topology.isMultiNode()) {
+        std::cout << "NUMA nodes: " << topology.nodeCount() << "\n";
+    }
+    std::unique_ptr<ShardCoordinator> coordinator;
+    if (!shards.empty()) {
+        coordinator = std::make_unique<ShardCoordinator>(shards, server.getThreadPool(), shardTimeoutMs);
+        server.setCoordinator(coordinator.get());
+        std::cout << "Coordinating " << shards.size() << " shards\n";
+    }
+
+    std::unique_ptr<replication::Leader> replicationLeader;
+    if (leader) {
+        server.getIndexManager().setMutationLog(&mutationLog);
+        replicationLeader = std::make_unique<replication::Leader>(server.getIndexManager(), mutationLog);
+        server.setReplicationLeader(replicationLeader.get());
+    }
+
+    std::unique_ptr<replication::Follower> follower;
+    if (!leaderEndpoint.empty()) {
+        follower = std::make_unique<replication::Follower>(server.getIndexManager(),
+                                                           leaderEndpoint.front().ip,
+                                                           leaderEndpoint.front().port);
+        server.setReadOnly(true);
+        follower->start();
+        std::cout << "Following " << followAddress << "\n";
+    }
+
+    std::vector<std::string> files;
+    for (const std::string& path : paths) {
+        collectFiles(path, files);
+    }
+    if (!files.empty() && follower) {
+        std::cerr << "A follower indexes nothing locally; ignoring paths\n";
+        files.clear();
+    }
+    if (!files.empty()) {
+        unsigned int added = coordinator ? coordinator->addFiles(files)
+                                         : server.getIndexManager().addFiles(files, server.getThreadPool());
+        std::cout << "Indexed " << added << " of " << files.size() << " files\n";
+    }
+
+    if (!server.initServer(ip, port)) {
+        Server::cleanupSockets();
+        return 1;
+    }
+
+    if (!ioCpus.empty() && !NumaTopology::pinCurrentThread(NumaTopology::parseCpuList(ioCpus))) {
+        std::cerr << "Cannot pin the accept thread to CPUs " << ioCpus << "\n";
+    }
 
-    producer1.join();
-    producer2.join();
+    server.acceptLoop();
 
-    consumer.detach();
+    if (follower) {
+        follower->stop();
+    }
+    if (replicationLeader) {
+        replicationLeader->stop();
+    }
 
+    Server::cleanupSockets();
     return 0;
 }
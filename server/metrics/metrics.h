@@ -0,0 +1,489 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Легка підсистема метрик:
+//   Counter          - лічильник, розбитий на шарди за потоками (без спільного кеш-рядка);
+//   Gauge            - поточне значення;
+//   LatencyHistogram - гістограма затримок у стилі HDR: 16 під-кошиків на кожну
+//                      степінь двійки, похибка перцентилів до ~6%.
+// Усі метрики живуть у глобальному Registry і ніколи не видаляються,
+// тому посилання на них можна кешувати в static-змінних.
+// З -DCW_DISABLE_METRICS запис перетворюється на no-op, а ScopedTimer і замір
+// очікування блокувань не читають годинник.
+
+namespace metrics {
+
+constexpr std::size_t kShards = 8;
+
+inline std::size_t currentShard() {
+    static std::atomic<std::size_t> nextShard(0);
+    thread_local std::size_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) % kShards;
+    return shard;
+}
+
+inline std::uint64_t nowNanos() {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+class Counter {
+public:
+    Counter() = default;
+
+    Counter(const Counter&)            = delete;
+    Counter& operator=(const Counter&) = delete;
+
+    void add(std::uint64_t n = 1) {
+    #ifndef CW_DISABLE_METRICS
+        shards[currentShard()].value.fetch_add(n, std::memory_order_relaxed);
+    #else
+        (void)n;
+    #endif
+    }
+
+    // Дзеркало монотонного значення, яке рахується деінде (статистика воркерів
+    // пулу): значення підтягується до total, якщо воно більше. Не змішувати з add().
+    void raiseTo(std::uint64_t total) {
+    #ifndef CW_DISABLE_METRICS
+        std::atomic<std::uint64_t>& value = shards[0].value;
+        std::uint64_t seen = value.load(std::memory_order_relaxed);
+        while (total > seen && !value.compare_exchange_weak(seen, total, std::memory_order_relaxed)) {
+        }
+    #else
+        (void)total;
+    #endif
+    }
+
+    std::uint64_t value() const {
+        std::uint64_t total = 0;
+        for (const Shard& shard : shards) {
+            total += shard.value.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<std::uint64_t> value{0};
+    };
+
+    Shard shards[kShards];
+};
+
+class Gauge {
+public:
+    Gauge()
+        : current(0)
+    {}
+
+    Gauge(const Gauge&)            = delete;
+    Gauge& operator=(const Gauge&) = delete;
+
+    void set(std::int64_t v) {
+        current.store(v, std::memory_order_relaxed);
+    }
+
+    void add(std::int64_t delta) {
+        current.fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    std::int64_t value() const {
+        return current.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<std::int64_t> current;
+};
+
+class LatencyHistogram {
+public:
+    static constexpr unsigned int kSubBucketBits = 4;
+    static constexpr unsigned int kSubBuckets    = 1u << kSubBucketBits;
+    static constexpr unsigned int kMaxBits       = 48;
+    static constexpr std::size_t  kBucketCount   = (kMaxBits - kSubBucketBits + 1) * kSubBuckets;
+
+    struct Snapshot {
+        std::uint64_t              count = 0;
+        std::uint64_t              sum   = 0;
+        std::uint64_t              max   = 0;
+        std::vector<std::uint64_t> buckets;
+
+        // Верхня межа кошика, у який потрапляє перцентиль q (0..1), у наносекундах.
+        std::uint64_t percentile(double q) const {
+            if (count == 0) {
+                return 0;
+            }
+            std::uint64_t rank = static_cast<std::uint64_t>(q * static_cast<double>(count) + 0.5);
+            if (rank == 0) {
+                rank = 1;
+            }
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i < buckets.size(); ++i) {
+                seen += buckets[i];
+                if (seen >= rank) {
+                    return std::min(bucketUpperBound(i), max);
+                }
+            }
+            return max;
+        }
+    };
+
+    LatencyHistogram() = default;
+
+    LatencyHistogram(const LatencyHistogram&)            = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(std::uint64_t nanos) {
+    #ifndef CW_DISABLE_METRICS
+        Shard& shard = shards[currentShard()];
+        shard.buckets[bucketIndex(nanos)].fetch_add(1, std::memory_order_relaxed);
+        shard.count.fetch_add(1, std::memory_order_relaxed);
+        shard.sum.fetch_add(nanos, std::memory_order_relaxed);
+
+        std::uint64_t seen = shard.max.load(std::memory_order_relaxed);
+        while (nanos > seen && !shard.max.compare_exchange_weak(seen, nanos, std::memory_order_relaxed)) {
+        }
+    #else
+        (void)nanos;
+    #endif
+    }
+
+    Snapshot snapshot() const {
+        Snapshot snap;
+        snap.buckets.assign(kBucketCount, 0);
+        for (const Shard& shard : shards) {
+            snap.count += shard.count.load(std::memory_order_relaxed);
+            snap.sum   += shard.sum.load(std::memory_order_relaxed);
+            snap.max    = std::max(snap.max, shard.max.load(std::memory_order_relaxed));
+            for (std::size_t i = 0; i < kBucketCount; ++i) {
+                snap.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+            }
+        }
+        return snap;
+    }
+
+    static std::size_t bucketIndex(std::uint64_t v) {
+        if (v < kSubBuckets) {
+            return static_cast<std::size_t>(v);
+        }
+        unsigned int msb = 63;
+        while (!((v >> msb) & 1)) {
+            --msb;
+        }
+        if (msb >= kMaxBits) {
+            return kBucketCount - 1;
+        }
+        unsigned int shift = msb - kSubBucketBits;
+        std::size_t  sub   = static_cast<std::size_t>((v >> shift) & (kSubBuckets - 1));
+        return (shift + 1) * kSubBuckets + sub;
+    }
+
+    static std::uint64_t bucketUpperBound(std::size_t index) {
+        if (index < kSubBuckets) {
+            return index;
+        }
+        std::size_t shift = index / kSubBuckets - 1;
+        std::size_t sub   = index % kSubBuckets;
+        return ((std::uint64_t(kSubBuckets + sub) + 1) << shift) - 1;
+    }
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<std::uint64_t> count{0};
+        std::atomic<std::uint64_t> sum{0};
+        std::atomic<std::uint64_t> max{0};
+        std::atomic<std::uint64_t> buckets[kBucketCount] = {};
+    };
+
+    Shard shards[kShards];
+};
+
+// Записує час життя об'єкта в гістограму.
+class ScopedTimer {
+public:
+#ifndef CW_DISABLE_METRICS
+    explicit ScopedTimer(LatencyHistogram& histogram)
+        : histogram(histogram)
+        , start(nowNanos())
+    {}
+
+    ~ScopedTimer() {
+        histogram.record(nowNanos() - start);
+    }
+#else
+    explicit ScopedTimer(LatencyHistogram&) {}
+#endif
+
+    ScopedTimer(const ScopedTimer&)            = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+#ifndef CW_DISABLE_METRICS
+private:
+    LatencyHistogram& histogram;
+    std::uint64_t     start;
+#endif
+};
+
+class Registry {
+public:
+    Registry() = default;
+
+    Registry(const Registry&)            = delete;
+    Registry& operator=(const Registry&) = delete;
+
+    // labels у форматі Prometheus без дужок: command="SEARCH_ANY",status="ok"
+    Counter& counter(const std::string& name, const std::string& help, const std::string& labels = "") {
+        return *get(name, help, labels, Kind::Counter).counter;
+    }
+
+    Gauge& gauge(const std::string& name, const std::string& help, const std::string& labels = "") {
+        return *get(name, help, labels, Kind::Gauge).gauge;
+    }
+
+    LatencyHistogram& histogram(const std::string& name, const std::string& help, const std::string& labels = "") {
+        return *get(name, help, labels, Kind::Histogram).histogram;
+    }
+
+    // Текстовий формат Prometheus (exposition format 0.0.4), час - у секундах.
+    std::string renderPrometheus() const {
+        static const std::uint64_t kBoundsNanos[] = {
+            1000ull, 5000ull, 10000ull, 50000ull, 100000ull, 500000ull,
+            1000000ull, 5000000ull, 10000000ull, 50000000ull, 100000000ull,
+            500000000ull, 1000000000ull, 5000000000ull
+        };
+
+        std::ostringstream oss;
+        std::lock_guard<std::mutex> lock(mutex);
+
+        std::string lastName;
+        for (const auto& item : entries) {
+            const Entry& e = *item.second;
+            if (e.name != lastName) {
+                oss << "# HELP " << e.name << " " << e.help << "\n";
+                oss << "# TYPE " << e.name << " " << typeName(e.kind) << "\n";
+                lastName = e.name;
+            }
+
+            if (e.kind == Kind::Counter) {
+                oss << e.name << braces(e.labels) << " " << e.counter->value() << "\n";
+            } else if (e.kind == Kind::Gauge) {
+                oss << e.name << braces(e.labels) << " " << e.gauge->value() << "\n";
+            } else {
+                LatencyHistogram::Snapshot snap = e.histogram->snapshot();
+                std::uint64_t cumulative = 0;
+                std::size_t   bucket     = 0;
+                for (std::uint64_t bound : kBoundsNanos) {
+                    while (bucket < snap.buckets.size() && LatencyHistogram::bucketUpperBound(bucket) <= bound) {
+                        cumulative += snap.buckets[bucket++];
+                    }
+                    oss << e.name << "_bucket" << braces(joinLabels(e.labels, "le=\"" + seconds(bound) + "\""))
+                        << " " << cumulative << "\n";
+                }
+                oss << e.name << "_bucket" << braces(joinLabels(e.labels, "le=\"+Inf\"")) << " " << snap.count << "\n";
+                oss << e.name << "_sum" << braces(e.labels) << " " << seconds(snap.sum) << "\n";
+                oss << e.name << "_count" << braces(e.labels) << " " << snap.count << "\n";
+            }
+        }
+        return oss.str();
+    }
+
+    // Короткий людський звіт: по рядку на метрику, для гістограм - p50/p99/p999 у мікросекундах.
+    std::vector<std::string> renderSummary() const {
+        std::vector<std::string> lines;
+        std::lock_guard<std::mutex> lock(mutex);
+
+        for (const auto& item : entries) {
+            const Entry& e = *item.second;
+            std::ostringstream oss;
+            oss << e.name << braces(e.labels) << " ";
+
+            if (e.kind == Kind::Counter) {
+                oss << e.counter->value();
+            } else if (e.kind == Kind::Gauge) {
+                oss << e.gauge->value();
+            } else {
+                LatencyHistogram::Snapshot snap = e.histogram->snapshot();
+                if (snap.count == 0) {
+                    continue;
+                }
+                oss << "count=" << snap.count
+                    << " p50_us=" << micros(snap.percentile(0.50))
+                    << " p99_us=" << micros(snap.percentile(0.99))
+                    << " p999_us=" << micros(snap.percentile(0.999))
+                    << " max_us=" << micros(snap.max);
+            }
+            lines.push_back(oss.str());
+        }
+        return lines;
+    }
+
+private:
+    enum class Kind {
+        Counter,
+        Gauge,
+        Histogram
+    };
+
+    struct Entry {
+        std::string                       name;
+        std::string                       help;
+        std::string                       labels;
+        Kind                              kind;
+        std::unique_ptr<Counter>          counter;
+        std::unique_ptr<Gauge>            gauge;
+        std::unique_ptr<LatencyHistogram> histogram;
+    };
+
+    Entry& get(const std::string& name, const std::string& help, const std::string& labels, Kind kind) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        std::pair<std::string, std::string> key(name, labels);
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+            return *it->second;
+        }
+
+        auto entry = std::make_unique<Entry>();
+        entry->name   = name;
+        entry->help   = help;
+        entry->labels = labels;
+        entry->kind   = kind;
+        if (kind == Kind::Counter) {
+            entry->counter = std::make_unique<Counter>();
+        } else if (kind == Kind::Gauge) {
+            entry->gauge = std::make_unique<Gauge>();
+        } else {
+            entry->histogram = std::make_unique<LatencyHistogram>();
+        }
+
+        Entry& result = *entry;
+        entries.emplace(key, std::move(entry));
+        return result;
+    }
+
+    static const char* typeName(Kind kind) {
+        switch (kind) {
+        case Kind::Counter:   return "counter";
+        case Kind::Gauge:     return "gauge";
+        case Kind::Histogram: return "histogram";
+        }
+        return "untyped";
+    }
+
+    static std::string braces(const std::string& labels) {
+        return labels.empty() ? std::string() : "{" + labels + "}";
+    }
+
+    static std::string joinLabels(const std::string& labels, const std::string& extra) {
+        return labels.empty() ? extra : labels + "," + extra;
+    }
+
+    static std::string seconds(std::uint64_t nanos) {
+        std::ostringstream oss;
+        oss << static_cast<double>(nanos) / 1e9;
+        return oss.str();
+    }
+
+    static std::string micros(std::uint64_t nanos) {
+        std::ostringstream oss;
+        oss << static_cast<double>(nanos) / 1e3;
+        return oss.str();
+    }
+
+private:
+    mutable std::mutex                            mutex;
+    std::map<std::pair<std::string, std::string>, std::unique_ptr<Entry>> entries;
+};
+
+inline Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+// Метрики блокувань однієї структури даних.
+struct LockMetrics {
+    Counter&          sharedAcquired;
+    Counter&          exclusiveAcquired;
+    Counter&          contended;
+    LatencyHistogram& sharedWait;
+    LatencyHistogram& exclusiveWait;
+};
+
+inline LockMetrics& lockMetricsFor(const std::string& structure) {
+    static std::mutex creationMutex;
+    static std::map<std::string, std::unique_ptr<LockMetrics>> byStructure;
+
+    std::lock_guard<std::mutex> lock(creationMutex);
+    auto it = byStructure.find(structure);
+    if (it != byStructure.end()) {
+        return *it->second;
+    }
+
+    Registry& r = registry();
+    std::string label = "structure=\"" + structure + "\"";
+    auto created = std::unique_ptr<LockMetrics>(new LockMetrics{
+        r.counter("cw_lock_acquisitions_total", "Lock acquisitions", label + ",mode=\"shared\""),
+        r.counter("cw_lock_acquisitions_total", "Lock acquisitions", label + ",mode=\"exclusive\""),
+        r.counter("cw_lock_contended_total", "Lock acquisitions that had to wait", label),
+        r.histogram("cw_lock_wait_seconds", "Time spent waiting for a contended lock", label + ",mode=\"shared\""),
+        r.histogram("cw_lock_wait_seconds", "Time spent waiting for a contended lock", label + ",mode=\"exclusive\"")
+    });
+    LockMetrics& result = *created;
+    byStructure.emplace(structure, std::move(created));
+    return result;
+}
+
+// Захоплення shared_mutex із заміром очікування.
+// Без конкуренції коштує одну спробу try_lock і один інкремент лічильника.
+template <typename Mutex>
+std::shared_lock<Mutex> lockShared(Mutex& m, LockMetrics& lm) {
+    std::shared_lock<Mutex> lock(m, std::try_to_lock);
+    lm.sharedAcquired.add();
+    if (!lock.owns_lock()) {
+    #ifndef CW_DISABLE_METRICS
+        std::uint64_t start = nowNanos();
+        lock.lock();
+        lm.contended.add();
+        lm.sharedWait.record(nowNanos() - start);
+    #else
+        lock.lock();
+    #endif
+    }
+    return lock;
+}
+
+template <typename Mutex>
+std::unique_lock<Mutex> lockExclusive(Mutex& m, LockMetrics& lm) {
+    std::unique_lock<Mutex> lock(m, std::try_to_lock);
+    lm.exclusiveAcquired.add();
+    if (!lock.owns_lock()) {
+    #ifndef CW_DISABLE_METRICS
+        std::uint64_t start = nowNanos();
+        lock.lock();
+        lm.contended.add();
+        lm.exclusiveWait.record(nowNanos() - start);
+    #else
+        lock.lock();
+    #endif
+    }
+    return lock;
+}
+
+} // namespace metrics
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef SOCKET_PLATFORM_H
+#define SOCKET_PLATFORM_H
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    #pragma comment(lib, "Ws2_32.lib")
+    typedef SOCKET SocketHandle;
+#else
+    #include <sys/types.h>
+    #include <sys/socket.h>
+    #include <sys/time.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <arpa/inet.h>
+    #include <unistd.h>
+    #define INVALID_SOCKET (-1)
+    #define SOCKET_ERROR   (-1)
+    typedef int SocketHandle;
+#endif
+
+inline void closeSocketHandle(SocketHandle s) {
+#ifdef _WIN32
+    ::closesocket(s);
+#else
+    ::close(s);
+#endif
+}
+
+// Тайм-аут лише на recv; 0 - без обмежень.
+inline bool setSocketReceiveTimeout(SocketHandle s, int timeoutMs) {
+    if (timeoutMs <= 0) {
+        return true;
+    }
+#ifdef _WIN32
+    DWORD tv = static_cast<DWORD>(timeoutMs);
+#else
+    timeval tv;
+    tv.tv_sec  = timeoutMs / 1000;
+    tv.tv_usec = (timeoutMs % 1000) * 1000;
+#endif
+    return setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&tv), sizeof(tv)) != SOCKET_ERROR;
+}
+
+// Тайм-аут на recv/send; 0 - без обмежень.
+inline bool setSocketTimeout(SocketHandle s, int timeoutMs) {
+    if (timeoutMs <= 0) {
+        return true;
+    }
+#ifdef _WIN32
+    DWORD tv = static_cast<DWORD>(timeoutMs);
+#else
+    timeval tv;
+    tv.tv_sec  = timeoutMs / 1000;
+    tv.tv_usec = (timeoutMs % 1000) * 1000;
+#endif
+    return setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&tv), sizeof(tv)) != SOCKET_ERROR
+        && setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&tv), sizeof(tv)) != SOCKET_ERROR;
+}
+
+#endif
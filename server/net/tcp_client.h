@@ -0,0 +1,108 @@
+#ifndef TCP_CLIENT_H
+#define TCP_CLIENT_H
+
+#include <string>
+#include <chrono>
+#include <cstdint>
+
+#include "socket_platform.h"
+
+// Мінімальний клієнт текстового протоколу сервера:
+// одне з'єднання - один запит, відповідь читається до закриття сокета.
+// Тайм-аут обмежує весь запит (з'єднання + відправка + читання), а не окремий recv.
+
+class TcpClient {
+public:
+    TcpClient(const std::string& ip, int port)
+        : ip(ip)
+        , port(port)
+        , timeoutMs(0)
+    {}
+
+    void setTimeout(int milliseconds) {
+        timeoutMs = milliseconds;
+    }
+
+    const std::string& getIp() const {
+        return ip;
+    }
+
+    int getPort() const {
+        return port;
+    }
+
+    bool request(const std::string& command, std::string& outResponse, std::string& outError) const {
+        outResponse.clear();
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+
+        SocketHandle s = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (s == INVALID_SOCKET) {
+            outError = "socket() failed";
+            return false;
+        }
+        setSocketTimeout(s, timeoutMs);
+
+        sockaddr_in addr;
+        addr.sin_family      = AF_INET;
+        addr.sin_port        = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = inet_addr(ip.c_str());
+
+        if (::connect(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == SOCKET_ERROR) {
+            closeSocketHandle(s);
+            outError = "connect() failed";
+            return false;
+        }
+
+        std::string payload = command;
+        if (payload.empty() || payload.back() != '\n') {
+            payload.push_back('\n');
+        }
+
+        const char* data = payload.data();
+        std::size_t left = payload.size();
+        while (left > 0) {
+            int sent = ::send(s, data, static_cast<int>(left), 0);
+            if (sent <= 0) {
+                closeSocketHandle(s);
+                outError = "send() failed";
+                return false;
+            }
+            data += sent;
+            left -= static_cast<std::size_t>(sent);
+        }
+
+        char buffer[16 * 1024];
+        for (;;) {
+            if (timeoutMs > 0) {
+                auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now()).count();
+                if (left <= 0) {
+                    closeSocketHandle(s);
+                    outError = "request timed out";
+                    return false;
+                }
+                setSocketTimeout(s, static_cast<int>(left));
+            }
+            int received = ::recv(s, buffer, sizeof(buffer), 0);
+            if (received == 0) {
+                break;
+            }
+            if (received < 0) {
+                closeSocketHandle(s);
+                outError = "recv() failed or timed out";
+                return false;
+            }
+            outResponse.append(buffer, static_cast<std::size_t>(received));
+        }
+
+        closeSocketHandle(s);
+        return true;
+    }
+
+private:
+    std::string ip;
+    int         port;
+    int         timeoutMs;
+};
+
+#endif
@@ -0,0 +1,247 @@
+#ifndef QUERY_PARSER_H
+#define QUERY_PARSER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cctype>
+#include <cstddef>
+
+// Булева мова запитів:
+//   expr    := andExpr ( "OR" andExpr )*
+//   andExpr := notExpr ( ["AND"] notExpr )*
+//   notExpr := "NOT" notExpr | primary
+//   primary := "(" expr ")" | WORD
+// Оператори - лише великими літерами, тому "and" / "not" лишаються звичайними словами.
+
+struct QueryNode {
+    enum class Kind {
+        Term,
+        And,
+        Or,
+        Not
+    };
+
+    explicit QueryNode(Kind k)
+        : kind(k)
+    {}
+
+    Kind                                    kind;
+    std::string                             term;
+    std::vector<std::unique_ptr<QueryNode>> children;
+};
+
+class QueryParser {
+public:
+    static constexpr std::size_t kMaxDepth = 64;
+
+    QueryParser() = default;
+
+    QueryParser(const QueryParser&)            = delete;
+    QueryParser& operator=(const QueryParser&) = delete;
+    QueryParser(QueryParser&&)                 = delete;
+    QueryParser& operator=(QueryParser&&)      = delete;
+
+    bool parse(const std::string& text,
+               std::unique_ptr<QueryNode>& outRoot,
+               std::string& outError) {
+        tokens.clear();
+        pos   = 0;
+        depth = 0;
+        error.clear();
+
+        tokenize(text);
+        if (tokens.empty()) {
+            outError = "Empty query";
+            return false;
+        }
+
+        std::unique_ptr<QueryNode> root = parseOr();
+        if (root && pos < tokens.size()) {
+            fail("Unexpected token '" + tokens[pos].text + "'");
+            root.reset();
+        }
+        if (!root) {
+            outError = error.empty() ? "Malformed query" : error;
+            return false;
+        }
+
+        outRoot = std::move(root);
+        return true;
+    }
+
+private:
+    enum class TokenType {
+        Word,
+        And,
+        Or,
+        Not,
+        LParen,
+        RParen
+    };
+
+    struct Token {
+        TokenType   type;
+        std::string text;
+    };
+
+    void tokenize(const std::string& text) {
+        std::string current;
+        auto flush = [&]() {
+            if (current.empty()) {
+                return;
+            }
+            if (current == "AND") {
+                tokens.push_back({TokenType::And, current});
+            } else if (current == "OR") {
+                tokens.push_back({TokenType::Or, current});
+            } else if (current == "NOT") {
+                tokens.push_back({TokenType::Not, current});
+            } else {
+                tokens.push_back({TokenType::Word, current});
+            }
+            current.clear();
+        };
+
+        for (char ch : text) {
+            if (ch == '(' || ch == ')') {
+                flush();
+                tokens.push_back({ch == '(' ? TokenType::LParen : TokenType::RParen, std::string(1, ch)});
+            } else if (std::isspace(static_cast<unsigned char>(ch))) {
+                flush();
+            } else {
+                current.push_back(ch);
+            }
+        }
+        flush();
+    }
+
+    bool atEnd() const {
+        return pos >= tokens.size();
+    }
+
+    bool peek(TokenType type) const {
+        return !atEnd() && tokens[pos].type == type;
+    }
+
+    void fail(const std::string& message) {
+        if (error.empty()) {
+            error = message;
+        }
+    }
+
+    std::unique_ptr<QueryNode> parseOr() {
+        std::unique_ptr<QueryNode> left = parseAnd();
+        if (!left) {
+            return nullptr;
+        }
+        if (!peek(TokenType::Or)) {
+            return left;
+        }
+
+        auto node = std::make_unique<QueryNode>(QueryNode::Kind::Or);
+        node->children.push_back(std::move(left));
+        while (peek(TokenType::Or)) {
+            ++pos;
+            std::unique_ptr<QueryNode> right = parseAnd();
+            if (!right) {
+                return nullptr;
+            }
+            node->children.push_back(std::move(right));
+        }
+        return node;
+    }
+
+    std::unique_ptr<QueryNode> parseAnd() {
+        std::unique_ptr<QueryNode> left = parseNot();
+        if (!left) {
+            return nullptr;
+        }
+
+        std::unique_ptr<QueryNode> node;
+        for (;;) {
+            if (peek(TokenType::And)) {
+                ++pos;
+            } else if (!(peek(TokenType::Word) || peek(TokenType::Not) || peek(TokenType::LParen))) {
+                break;
+            }
+
+            std::unique_ptr<QueryNode> right = parseNot();
+            if (!right) {
+                return nullptr;
+            }
+            if (!node) {
+                node = std::make_unique<QueryNode>(QueryNode::Kind::And);
+                node->children.push_back(std::move(left));
+            }
+            node->children.push_back(std::move(right));
+        }
+        return node ? std::move(node) : std::move(left);
+    }
+
+    std::unique_ptr<QueryNode> parseNot() {
+        if (!peek(TokenType::Not)) {
+            return parsePrimary();
+        }
+
+        ++pos;
+        if (++depth > kMaxDepth) {
+            fail("Query nested too deeply");
+            return nullptr;
+        }
+        std::unique_ptr<QueryNode> operand = parseNot();
+        --depth;
+        if (!operand) {
+            return nullptr;
+        }
+
+        auto node = std::make_unique<QueryNode>(QueryNode::Kind::Not);
+        node->children.push_back(std::move(operand));
+        return node;
+    }
+
+    std::unique_ptr<QueryNode> parsePrimary() {
+        if (atEnd()) {
+            fail("Unexpected end of query");
+            return nullptr;
+        }
+
+        const Token& token = tokens[pos];
+        if (token.type == TokenType::Word) {
+            ++pos;
+            auto node = std::make_unique<QueryNode>(QueryNode::Kind::Term);
+            node->term = token.text;
+            return node;
+        }
+
+        if (token.type == TokenType::LParen) {
+            ++pos;
+            if (++depth > kMaxDepth) {
+                fail("Query nested too deeply");
+                return nullptr;
+            }
+            std::unique_ptr<QueryNode> inner = parseOr();
+            --depth;
+            if (!inner) {
+                return nullptr;
+            }
+            if (!peek(TokenType::RParen)) {
+                fail("Missing ')'");
+                return nullptr;
+            }
+            ++pos;
+            return inner;
+        }
+
+        fail("Unexpected token '" + token.text + "'");
+        return nullptr;
+    }
+
+private:
+    std::vector<Token> tokens;
+    std::size_t        pos   = 0;
+    std::size_t        depth = 0;
+    std::string        error;
+};
+
+#endif
@@ -0,0 +1,328 @@
+#ifndef QUERY_PLANNER_H
+#define QUERY_PLANNER_H
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <cstddef>
+
+#include "query_parser.h"
+#include "posting_list.h"
+#include "thread_pool.h"
+#include "deadline.h"
+
+// План виконання булевого запиту.
+//   - NOT проштовхується вниз і виконується як ANDNOT;
+//   - операнди AND впорядковуються за зростанням кількості документів;
+//   - порожні гілки відкидаються ще до читання списків;
+//   - якщо термін запиту вийшов, виконання зупиняється з порожнім результатом.
+//
+// Source має надавати:
+//   bool        lookupTerm(const std::string& term, unsigned int& outWordId, std::size_t& outCount) const;
+//   void        fetchTerm(unsigned int wordId, PostingList& out) const;
+//   void        fetchAll(PostingList& out) const;
+//   std::size_t documentCount() const;
+
+struct PlanNode {
+    enum class Kind {
+        Empty,
+        All,
+        Term,
+        And,
+        Or
+    };
+
+    explicit PlanNode(Kind k)
+        : kind(k)
+        , wordId(0)
+        , estimate(0)
+    {}
+
+    Kind                                   kind;
+    unsigned int                           wordId;
+    std::size_t                            estimate;
+    std::vector<std::unique_ptr<PlanNode>> include;
+    std::vector<std::unique_ptr<PlanNode>> exclude;
+};
+
+template <typename Source>
+class QueryPlanner {
+public:
+    QueryPlanner(const Source& source, ThreadPool* pool, const Deadline* deadline = nullptr)
+        : source(source)
+        , pool(pool)
+        , deadline(deadline)
+        , universe(source.documentCount())
+    {}
+
+    QueryPlanner(const QueryPlanner&)            = delete;
+    QueryPlanner& operator=(const QueryPlanner&) = delete;
+    QueryPlanner(QueryPlanner&&)                 = delete;
+    QueryPlanner& operator=(QueryPlanner&&)      = delete;
+
+    std::unique_ptr<PlanNode> plan(const QueryNode& root) const {
+        Planned planned = planNode(root);
+        if (!planned.negated) {
+            return std::move(planned.node);
+        }
+
+        std::unique_ptr<PlanNode> node = makeAll();
+        node = makeAndNot(std::move(node), std::move(planned.node));
+        return node;
+    }
+
+    void execute(const PlanNode& node, PostingList& out) const {
+        out.clear();
+        if (expired()) {
+            return;
+        }
+
+        switch (node.kind) {
+        case PlanNode::Kind::Empty:
+            return;
+
+        case PlanNode::Kind::All:
+            source.fetchAll(out);
+            return;
+
+        case PlanNode::Kind::Term:
+            source.fetchTerm(node.wordId, out);
+            return;
+
+        case PlanNode::Kind::And: {
+            execute(*node.include.front(), out);
+            PostingList operand;
+            for (std::size_t i = 1; i < node.include.size() && !out.empty() && !expired(); ++i) {
+                execute(*node.include[i], operand);
+                out.intersectWith(operand);
+            }
+            for (std::size_t i = 0; i < node.exclude.size() && !out.empty() && !expired(); ++i) {
+                execute(*node.exclude[i], operand);
+                out.subtractWith(operand);
+            }
+            return;
+        }
+
+        case PlanNode::Kind::Or: {
+            std::vector<PostingList> operands(node.include.size());
+            auto run = [&](std::size_t lo, std::size_t hi) {
+                for (std::size_t i = lo; i < hi; ++i) {
+                    execute(*node.include[i], operands[i]);
+                }
+            };
+            if (pool != nullptr && operands.size() > 1) {
+                pool->parallelFor(0, operands.size(), run, 1);
+            } else {
+                run(0, operands.size());
+            }
+            if (expired()) {
+                return;
+            }
+
+            // Найбільший операнд - основа, решта вливаються в нього.
+            auto largest = std::max_element(operands.begin(), operands.end(),
+                                            [](const PostingList& lhs, const PostingList& rhs) {
+                                                return lhs.cardinality() < rhs.cardinality();
+                                            });
+            out = std::move(*largest);
+            for (auto it = operands.begin(); it != operands.end(); ++it) {
+                if (it != largest) {
+                    out.uniteWith(*it);
+                }
+            }
+            return;
+        }
+        }
+    }
+
+private:
+    bool expired() const {
+        return deadline != nullptr && deadline->expired();
+    }
+
+    struct Planned {
+        std::unique_ptr<PlanNode> node;
+        bool                      negated;
+    };
+
+    Planned planNode(const QueryNode& query) const {
+        switch (query.kind) {
+        case QueryNode::Kind::Term:
+            return {makeTerm(query.term), false};
+
+        case QueryNode::Kind::Not: {
+            Planned inner = planNode(*query.children.front());
+            inner.negated = !inner.negated;
+            return inner;
+        }
+
+        case QueryNode::Kind::And: {
+            std::vector<std::unique_ptr<PlanNode>> positives;
+            std::vector<std::unique_ptr<PlanNode>> negatives;
+            for (const auto& child : query.children) {
+                Planned planned = planNode(*child);
+                (planned.negated ? negatives : positives).push_back(std::move(planned.node));
+            }
+            return {makeAnd(std::move(positives), std::move(negatives)), false};
+        }
+
+        case QueryNode::Kind::Or: {
+            std::vector<std::unique_ptr<PlanNode>> positives;
+            std::vector<std::unique_ptr<PlanNode>> negatives;
+            for (const auto& child : query.children) {
+                Planned planned = planNode(*child);
+                (planned.negated ? negatives : positives).push_back(std::move(planned.node));
+            }
+
+            if (negatives.empty()) {
+                return {makeOr(std::move(positives)), false};
+            }
+
+            // p1 OR NOT n1 OR NOT n2 = NOT (n1 AND n2 AND NOT p1)
+            return {makeAnd(std::move(negatives), std::move(positives)), true};
+        }
+        }
+
+        return {std::make_unique<PlanNode>(PlanNode::Kind::Empty), false};
+    }
+
+    std::unique_ptr<PlanNode> makeTerm(const std::string& term) const {
+        unsigned int wordId = 0;
+        std::size_t  count  = 0;
+        if (!source.lookupTerm(term, wordId, count) || count == 0) {
+            return std::make_unique<PlanNode>(PlanNode::Kind::Empty);
+        }
+
+        auto node = std::make_unique<PlanNode>(PlanNode::Kind::Term);
+        node->wordId   = wordId;
+        node->estimate = count;
+        return node;
+    }
+
+    std::unique_ptr<PlanNode> makeAll() const {
+        if (universe == 0) {
+            return std::make_unique<PlanNode>(PlanNode::Kind::Empty);
+        }
+        auto node = std::make_unique<PlanNode>(PlanNode::Kind::All);
+        node->estimate = universe;
+        return node;
+    }
+
+    std::unique_ptr<PlanNode> makeAndNot(std::unique_ptr<PlanNode> base,
+                                         std::unique_ptr<PlanNode> excluded) const {
+        std::vector<std::unique_ptr<PlanNode>> positives;
+        std::vector<std::unique_ptr<PlanNode>> negatives;
+        positives.push_back(std::move(base));
+        negatives.push_back(std::move(excluded));
+        return makeAnd(std::move(positives), std::move(negatives));
+    }
+
+    std::unique_ptr<PlanNode> makeAnd(std::vector<std::unique_ptr<PlanNode>> positives,
+                                      std::vector<std::unique_ptr<PlanNode>> negatives) const {
+        std::vector<std::unique_ptr<PlanNode>> include;
+        std::vector<std::unique_ptr<PlanNode>> exclude;
+
+        for (auto& child : positives) {
+            if (child->kind == PlanNode::Kind::Empty) {
+                return std::make_unique<PlanNode>(PlanNode::Kind::Empty);
+            }
+            if (child->kind == PlanNode::Kind::And) {
+                for (auto& inner : child->include) {
+                    include.push_back(std::move(inner));
+                }
+                for (auto& inner : child->exclude) {
+                    exclude.push_back(std::move(inner));
+                }
+                continue;
+            }
+            include.push_back(std::move(child));
+        }
+
+        for (auto& child : negatives) {
+            if (child->kind == PlanNode::Kind::Empty) {
+                continue;
+            }
+            if (child->kind == PlanNode::Kind::All) {
+                return std::make_unique<PlanNode>(PlanNode::Kind::Empty);
+            }
+            exclude.push_back(std::move(child));
+        }
+
+        // Повний набір документів потрібен лише як основа для ANDNOT.
+        include.erase(std::remove_if(include.begin(), include.end(),
+                                     [](const std::unique_ptr<PlanNode>& n) {
+                                         return n->kind == PlanNode::Kind::All;
+                                     }),
+                      include.end());
+        if (include.empty()) {
+            include.push_back(makeAll());
+            if (include.front()->kind == PlanNode::Kind::Empty) {
+                return std::move(include.front());
+            }
+        }
+
+        if (include.size() == 1 && exclude.empty()) {
+            return std::move(include.front());
+        }
+
+        auto byEstimate = [](const std::unique_ptr<PlanNode>& lhs, const std::unique_ptr<PlanNode>& rhs) {
+            return lhs->estimate < rhs->estimate;
+        };
+        std::sort(include.begin(), include.end(), byEstimate);
+        std::sort(exclude.begin(), exclude.end(),
+                  [&](const std::unique_ptr<PlanNode>& lhs, const std::unique_ptr<PlanNode>& rhs) {
+                      return byEstimate(rhs, lhs);
+                  });
+
+        auto node = std::make_unique<PlanNode>(PlanNode::Kind::And);
+        node->estimate = include.front()->estimate;
+        node->include  = std::move(include);
+        node->exclude  = std::move(exclude);
+        return node;
+    }
+
+    std::unique_ptr<PlanNode> makeOr(std::vector<std::unique_ptr<PlanNode>> children) const {
+        std::vector<std::unique_ptr<PlanNode>> include;
+        std::size_t estimate = 0;
+
+        for (auto& child : children) {
+            if (child->kind == PlanNode::Kind::Empty) {
+                continue;
+            }
+            if (child->kind == PlanNode::Kind::All) {
+                return makeAll();
+            }
+            if (child->kind == PlanNode::Kind::Or) {
+                for (auto& inner : child->include) {
+                    estimate += inner->estimate;
+                    include.push_back(std::move(inner));
+                }
+                continue;
+            }
+            estimate += child->estimate;
+            include.push_back(std::move(child));
+        }
+
+        if (include.empty()) {
+            return std::make_unique<PlanNode>(PlanNode::Kind::Empty);
+        }
+        if (include.size() == 1) {
+            return std::move(include.front());
+        }
+
+        auto node = std::make_unique<PlanNode>(PlanNode::Kind::Or);
+        node->estimate = std::min(estimate, universe);
+        node->include  = std::move(include);
+        return node;
+    }
+
+private:
+    const Source&   source;
+    ThreadPool*     pool;
+    const Deadline* deadline;
+    std::size_t     universe;
+};
+
+#endif
@@ -0,0 +1,233 @@
+#ifndef MUTATION_LOG_H
+#define MUTATION_LOG_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <random>
+#include <utility>
+#include <cstdint>
+#include <cstdlib>
+
+#include "metrics.h"
+
+// Одна зміна індексу з уже визначеними ID - репліка відтворює стан лідера
+// без повторного читання файлів і без власного призначення ID.
+struct Mutation {
+    enum class Kind {
+        Upsert,     // додавання або переіндексація: повний набір слів документа
+        Remove,
+        Clear
+    };
+
+    Kind                                              kind  = Kind::Upsert;
+    unsigned int                                      docId = 0;
+    std::string                                       docPath;
+    std::vector<std::pair<unsigned int, std::string>> words;    // (wordId, слово)
+};
+
+// Журнал змін лідера: обмежене вікно останніх записів у вже закодованому вигляді
+// (кодується один раз, відправляється всім фоловерам).
+// Формат запису (текстовий, як і решта протоколу):
+//   ADD <seq> <docId> <n>\n<шлях>\n<wordId> <слово>\n  ... n разів
+//   REMOVE <seq> <docId>\n<шлях>\n
+//   CLEAR <seq>\n
+// Epoch - випадковий ідентифікатор журналу: після перезапуску лідера номери
+// seq починаються заново, і фоловер зі старим epoch отримує знімок.
+class MutationLog {
+public:
+    enum class ReadStatus {
+        Ok,         // out містить записи від fromSeq (або порожній після очікування)
+        Truncated,  // fromSeq вже витіснено з вікна - потрібен знімок
+        Stopped
+    };
+
+    explicit MutationLog(std::size_t capacity = 1 << 16)
+        : capacity(capacity == 0 ? 1 : capacity)
+        , lastSequence(0)
+        , stopped(false)
+        , logSeq(metrics::registry().gauge("cw_replication_log_seq", "Last sequence number in the mutation log"))
+    {
+        std::random_device rd;
+        logEpoch = (static_cast<std::uint64_t>(rd()) << 32) ^ rd()
+                 ^ static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    }
+
+    MutationLog(const MutationLog&)            = delete;
+    MutationLog& operator=(const MutationLog&) = delete;
+    MutationLog(MutationLog&&)                 = delete;
+    MutationLog& operator=(MutationLog&&)      = delete;
+
+    std::uint64_t append(const Mutation& mutation) {
+        std::string body = encodeBody(mutation);
+
+        std::uint64_t seq = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            seq = ++lastSequence;
+            entries.push_back(encodeHeader(mutation, seq) + body);
+            if (entries.size() > capacity) {
+                entries.pop_front();
+            }
+        }
+        logSeq.set(static_cast<std::int64_t>(seq));
+        available.notify_all();
+        return seq;
+    }
+
+    // Чекає до waitMs, поки з'явиться запис fromSeq, і віддає до maxRecords записів.
+    ReadStatus read(std::uint64_t fromSeq,
+                    std::vector<std::string>& out,
+                    std::size_t maxRecords,
+                    int waitMs) {
+        out.clear();
+        std::unique_lock<std::mutex> lock(mutex);
+        available.wait_for(lock, std::chrono::milliseconds(waitMs), [&]() {
+            return stopped || lastSequence >= fromSeq;
+        });
+        if (stopped) {
+            return ReadStatus::Stopped;
+        }
+
+        std::uint64_t first = lastSequence - entries.size() + 1;
+        if (fromSeq < first || fromSeq > lastSequence + 1) {
+            return ReadStatus::Truncated;
+        }
+        for (std::uint64_t seq = fromSeq; seq <= lastSequence && out.size() < maxRecords; ++seq) {
+            out.push_back(entries[static_cast<std::size_t>(seq - first)]);
+        }
+        return ReadStatus::Ok;
+    }
+
+    std::uint64_t lastSeq() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return lastSequence;
+    }
+
+    std::uint64_t epoch() const {
+        return logEpoch;
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopped = true;
+        }
+        available.notify_all();
+    }
+
+    static std::string encode(const Mutation& mutation, std::uint64_t seq) {
+        return encodeHeader(mutation, seq) + encodeBody(mutation);
+    }
+
+    // Розбирає запис, перший рядок якого вже прочитано в header.
+    // LineSource::readLine(std::string&) повертає false, якщо з'єднання обірвалося.
+    template <typename LineSource>
+    static bool decode(const std::string& header,
+                       LineSource& source,
+                       Mutation& outMutation,
+                       std::uint64_t& outSeq,
+                       std::string& outError) {
+        outMutation = Mutation();
+
+        std::vector<std::string> fields;
+        std::size_t pos = 0;
+        while (pos < header.size()) {
+            std::size_t space = header.find(' ', pos);
+            if (space == std::string::npos) {
+                space = header.size();
+            }
+            fields.push_back(header.substr(pos, space - pos));
+            pos = space + 1;
+        }
+
+        if (fields.size() == 2 && fields[0] == "CLEAR") {
+            outMutation.kind = Mutation::Kind::Clear;
+            outSeq = std::strtoull(fields[1].c_str(), nullptr, 10);
+            return true;
+        }
+        if (fields.size() == 3 && fields[0] == "REMOVE") {
+            outMutation.kind  = Mutation::Kind::Remove;
+            outSeq            = std::strtoull(fields[1].c_str(), nullptr, 10);
+            outMutation.docId = static_cast<unsigned int>(std::strtoul(fields[2].c_str(), nullptr, 10));
+            if (!source.readLine(outMutation.docPath)) {
+                outError = "Truncated REMOVE record";
+                return false;
+            }
+            return true;
+        }
+        if (fields.size() == 4 && fields[0] == "ADD") {
+            outMutation.kind  = Mutation::Kind::Upsert;
+            outSeq            = std::strtoull(fields[1].c_str(), nullptr, 10);
+            outMutation.docId = static_cast<unsigned int>(std::strtoul(fields[2].c_str(), nullptr, 10));
+            std::size_t count = std::strtoull(fields[3].c_str(), nullptr, 10);
+            if (!source.readLine(outMutation.docPath)) {
+                outError = "Truncated ADD record";
+                return false;
+            }
+            outMutation.words.reserve(count);
+            std::string line;
+            for (std::size_t i = 0; i < count; ++i) {
+                if (!source.readLine(line)) {
+                    outError = "Truncated ADD record";
+                    return false;
+                }
+                std::size_t space = line.find(' ');
+                if (space == std::string::npos) {
+                    outError = "Malformed word in ADD record";
+                    return false;
+                }
+                outMutation.words.emplace_back(
+                    static_cast<unsigned int>(std::strtoul(line.c_str(), nullptr, 10)),
+                    line.substr(space + 1));
+            }
+            return true;
+        }
+
+        outError = "Unknown record: " + header;
+        return false;
+    }
+
+private:
+    static std::string encodeHeader(const Mutation& mutation, std::uint64_t seq) {
+        switch (mutation.kind) {
+        case Mutation::Kind::Upsert:
+            return "ADD " + std::to_string(seq) + " " + std::to_string(mutation.docId)
+                 + " " + std::to_string(mutation.words.size()) + "\n";
+        case Mutation::Kind::Remove:
+            return "REMOVE " + std::to_string(seq) + " " + std::to_string(mutation.docId) + "\n";
+        case Mutation::Kind::Clear:
+        default:
+            return "CLEAR " + std::to_string(seq) + "\n";
+        }
+    }
+
+    static std::string encodeBody(const Mutation& mutation) {
+        if (mutation.kind == Mutation::Kind::Clear) {
+            return std::string();
+        }
+        std::string body = mutation.docPath + "\n";
+        for (const auto& word : mutation.words) {
+            body += std::to_string(word.first);
+            body += ' ';
+            body += word.second;
+            body += '\n';
+        }
+        return body;
+    }
+
+private:
+    std::size_t                capacity;
+    std::uint64_t              lastSequence;
+    std::uint64_t              logEpoch;
+    bool                       stopped;
+    std::deque<std::string>    entries;
+    mutable std::mutex         mutex;
+    std::condition_variable    available;
+    metrics::Gauge&            logSeq;
+};
+
+#endif
@@ -0,0 +1,465 @@
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+
+#include "index_manager.h"
+#include "mutation_log.h"
+#include "socket_platform.h"
+#include "metrics.h"
+
+// Потокова реплікація лідер -> фоловери поверх того самого TCP-порту.
+//
+// Фоловер відкриває з'єднання і надсилає
+//   REPLICATE <epoch> <nextSeq>
+// Лідер відповідає "OK <epoch>\n" і далі не закриває з'єднання:
+//   - якщо epoch не збігається або nextSeq уже витіснено з журналу -
+//     спершу знімок: "SNAPSHOT <seq>\n", записи ADD для кожного документа,
+//     "SNAPSHOT_END <seq>\n";
+//   - потім записи журналу по мірі появи (формат MutationLog);
+//   - раз на kHeartbeatMs без змін - "PING <lastSeq>\n".
+
+namespace replication {
+
+constexpr int kHeartbeatMs = 1000;
+
+inline bool sendAll(SocketHandle s, const std::string& data) {
+    const char* ptr  = data.data();
+    std::size_t left = data.size();
+    while (left > 0) {
+        int sent = ::send(s, ptr, static_cast<int>(left), 0);
+        if (sent <= 0) {
+            return false;
+        }
+        ptr  += sent;
+        left -= static_cast<std::size_t>(sent);
+    }
+    return true;
+}
+
+inline void shutdownSocket(SocketHandle s) {
+#ifdef _WIN32
+    ::shutdown(s, SD_BOTH);
+#else
+    ::shutdown(s, SHUT_RDWR);
+#endif
+}
+
+// Порядкове читання з сокета з буфером.
+class LineReader {
+public:
+    explicit LineReader(SocketHandle s)
+        : socket(s)
+        , pos(0)
+    {}
+
+    bool readLine(std::string& outLine) {
+        for (;;) {
+            std::size_t eol = buffer.find('\n', pos);
+            if (eol != std::string::npos) {
+                outLine.assign(buffer, pos, eol - pos);
+                pos = eol + 1;
+                return true;
+            }
+            buffer.erase(0, pos);
+            pos = 0;
+
+            char chunk[16 * 1024];
+            int received = ::recv(socket, chunk, sizeof(chunk), 0);
+            if (received <= 0) {
+                return false;
+            }
+            buffer.append(chunk, static_cast<std::size_t>(received));
+        }
+    }
+
+private:
+    SocketHandle socket;
+    std::string  buffer;
+    std::size_t  pos;
+};
+
+// Сторона лідера: по одному потоку на фоловера (з'єднання довгоживучі,
+// тримати під них воркери пулу не можна).
+class Leader {
+public:
+    Leader(const IndexManager& index, MutationLog& log)
+        : index(index)
+        , log(log)
+        , stopping(false)
+        , followers(metrics::registry().gauge("cw_replication_followers", "Connected replication followers"))
+        , snapshots(metrics::registry().counter("cw_replication_snapshots_sent_total",
+                                                "Snapshots streamed to followers"))
+    {}
+
+    ~Leader() {
+        stop();
+    }
+
+    Leader(const Leader&)            = delete;
+    Leader& operator=(const Leader&) = delete;
+    Leader(Leader&&)                 = delete;
+    Leader& operator=(Leader&&)      = delete;
+
+    // Забирає сокет у власність; запит REPLICATE вже прочитано.
+    void serve(SocketHandle s, std::uint64_t followerEpoch, std::uint64_t nextSeq) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) {
+            closeSocketHandle(s);
+            return;
+        }
+        // Потоки відключених фоловерів приєднуються тут, а не лише в stop():
+        // інакше кожне перепідключення лишало б по об'єкту потоку.
+        std::vector<std::thread> toJoin;
+        takeFinished(toJoin);
+        for (std::thread& t : toJoin) {
+            t.join();
+        }
+        sockets.push_back(s);
+        threads.emplace_back([this, s, followerEpoch, nextSeq]() {
+            followers.add(1);
+            stream(s, followerEpoch, nextSeq);
+            followers.add(-1);
+
+            std::lock_guard<std::mutex> guard(mutex);
+            for (std::size_t i = 0; i < sockets.size(); ++i) {
+                if (sockets[i] == s) {
+                    sockets.erase(sockets.begin() + static_cast<std::ptrdiff_t>(i));
+                    closeSocketHandle(s);
+                    break;
+                }
+            }
+            finished.push_back(std::this_thread::get_id());
+        });
+    }
+
+    void stop() {
+        std::vector<std::thread> toJoin;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) {
+                return;
+            }
+            stopping = true;
+            for (SocketHandle s : sockets) {
+                shutdownSocket(s);
+            }
+            toJoin.swap(threads);
+            finished.clear();
+        }
+        log.stop();
+        for (std::thread& t : toJoin) {
+            t.join();
+        }
+    }
+
+private:
+    // Забирає з threads потоки, що вже завершили stream(). Під mutex; такий
+    // потік після запису в finished лише відпускає mutex, тож join не чекає.
+    void takeFinished(std::vector<std::thread>& out) {
+        for (std::thread::id id : finished) {
+            for (std::size_t i = 0; i < threads.size(); ++i) {
+                if (threads[i].get_id() == id) {
+                    out.push_back(std::move(threads[i]));
+                    threads.erase(threads.begin() + static_cast<std::ptrdiff_t>(i));
+                    break;
+                }
+            }
+        }
+        finished.clear();
+    }
+
+    void stream(SocketHandle s, std::uint64_t followerEpoch, std::uint64_t nextSeq) {
+        if (!sendAll(s, "OK " + std::to_string(log.epoch()) + "\n")) {
+            return;
+        }
+
+        bool needSnapshot = followerEpoch != log.epoch() || nextSeq == 0;
+        std::vector<std::string> batch;
+        while (!stopping.load()) {
+            if (needSnapshot) {
+                if (!sendSnapshot(s, nextSeq)) {
+                    return;
+                }
+                needSnapshot = false;
+            }
+
+            MutationLog::ReadStatus status = log.read(nextSeq, batch, 1024, kHeartbeatMs);
+            if (status == MutationLog::ReadStatus::Stopped) {
+                return;
+            }
+            if (status == MutationLog::ReadStatus::Truncated) {
+                needSnapshot = true;
+                continue;
+            }
+
+            std::string payload;
+            if (batch.empty()) {
+                payload = "PING " + std::to_string(nextSeq - 1) + "\n";
+            }
+            for (const std::string& record : batch) {
+                payload += record;
+            }
+            if (!sendAll(s, payload)) {
+                return;
+            }
+            nextSeq += batch.size();
+        }
+    }
+
+    // Номер знімка береться до обходу індексу: усі записи до нього вже
+    // застосовані (запис у журнал іде після зміни індексу).
+    bool sendSnapshot(SocketHandle s, std::uint64_t& outNextSeq) {
+        snapshots.add();
+        std::uint64_t seq = log.lastSeq();
+        std::string payload = "SNAPSHOT " + std::to_string(seq) + "\n";
+        bool ok = true;
+        index.forEachDocument([&](const Mutation& mutation) {
+            if (!ok) {
+                return;
+            }
+            payload += MutationLog::encode(mutation, seq);
+            if (payload.size() >= 256 * 1024) {
+                ok = sendAll(s, payload);
+                payload.clear();
+            }
+        });
+        payload += "SNAPSHOT_END " + std::to_string(seq) + "\n";
+        if (!ok || !sendAll(s, payload)) {
+            return false;
+        }
+        outNextSeq = seq + 1;
+        return true;
+    }
+
+private:
+    const IndexManager&          index;
+    MutationLog&                 log;
+    std::atomic<bool>            stopping;
+    std::mutex                   mutex;
+    std::vector<SocketHandle>    sockets;
+    std::vector<std::thread>     threads;
+    std::vector<std::thread::id> finished;      // завершені, ще не приєднані
+    metrics::Gauge&              followers;
+    metrics::Counter&            snapshots;
+};
+
+// Сторона фоловера: фоновий потік тримає з'єднання з лідером, застосовує записи
+// до локального IndexManager і перепідключається з продовженням від appliedSeq.
+class Follower {
+public:
+    Follower(IndexManager& index, const std::string& leaderIp, int leaderPort)
+        : index(index)
+        , leaderIp(leaderIp)
+        , leaderPort(leaderPort)
+        , leaderEpoch(0)
+        , applied(0)
+        , connects(0)
+        , stopping(false)
+        , activeSocket(INVALID_SOCKET)
+        , appliedSeqGauge(metrics::registry().gauge("cw_replication_applied_seq",
+                                                    "Last leader sequence applied by this follower"))
+        , snapshots(metrics::registry().counter("cw_replication_snapshots_loaded_total",
+                                                "Snapshots loaded from the leader"))
+        , reconnects(metrics::registry().counter("cw_replication_reconnects_total",
+                                                 "Connections opened to the leader"))
+    {}
+
+    ~Follower() {
+        stop();
+    }
+
+    Follower(const Follower&)            = delete;
+    Follower& operator=(const Follower&) = delete;
+    Follower(Follower&&)                 = delete;
+    Follower& operator=(Follower&&)      = delete;
+
+    void start() {
+        worker = std::thread([this]() { run(); });
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            if (activeSocket != INVALID_SOCKET) {
+                shutdownSocket(activeSocket);
+            }
+        }
+        wakeUp.notify_all();
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+
+    std::uint64_t appliedSeq() const {
+        return applied.load();
+    }
+
+    // Чекає, поки фоловер застосує запис seq (для тестів і бенчмарків).
+    bool waitForSeq(std::uint64_t seq, int timeoutMs) const {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (applied.load() < seq) {
+            if (std::chrono::steady_clock::now() >= deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        return true;
+    }
+
+    // Скільки разів фоловер під'єднувався до лідера (для тестів відступу).
+    std::uint64_t connectCount() const {
+        return connects.load();
+    }
+
+private:
+    void run() {
+        int backoffMs = 100;
+        for (;;) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (stopping) {
+                    return;
+                }
+            }
+            if (session()) {
+                backoffMs = 100;
+            }
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeUp.wait_for(lock, std::chrono::milliseconds(backoffMs), [this]() { return stopping; });
+            backoffMs = std::min(backoffMs * 2, 2000);
+        }
+    }
+
+    // Одне з'єднання з лідером. true лише для здорової сесії (див. consume):
+    // відмова чи помилка потоку одразу після з'єднання не скидає відступ.
+    bool session() {
+        SocketHandle s = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (s == INVALID_SOCKET) {
+            return false;
+        }
+        // Лідер шле PING щосекунди: довша тиша означає, що з'єднання мертве.
+        setSocketTimeout(s, kHeartbeatMs * 5);
+
+        sockaddr_in addr;
+        addr.sin_family      = AF_INET;
+        addr.sin_port        = htons(static_cast<uint16_t>(leaderPort));
+        addr.sin_addr.s_addr = inet_addr(leaderIp.c_str());
+        if (::connect(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == SOCKET_ERROR) {
+            closeSocketHandle(s);
+            return false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) {
+                closeSocketHandle(s);
+                return false;
+            }
+            activeSocket = s;
+        }
+        reconnects.add();
+        connects.fetch_add(1);
+
+        std::string request = "REPLICATE " + std::to_string(leaderEpoch) + " "
+                            + std::to_string(applied.load() + 1) + "\n";
+        bool healthy = sendAll(s, request) && consume(s);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        activeSocket = INVALID_SOCKET;
+        closeSocketHandle(s);
+        return healthy;
+    }
+
+    // true, якщо лідер відповів "OK <epoch>" і прийшов хоча б один рядок
+    // потоку (запис, знімок або PING).
+    bool consume(SocketHandle s) {
+        LineReader reader(s);
+        std::string line;
+        if (!reader.readLine(line) || line.compare(0, 3, "OK ") != 0) {
+            std::cerr << "Replication handshake failed: " << line << "\n";
+            return false;
+        }
+        // Epoch лідера запам'ятовується лише після повного знімка: якщо з'єднання
+        // обірветься посередині, наступне теж почнеться зі знімка.
+        std::uint64_t offeredEpoch = std::strtoull(line.c_str() + 3, nullptr, 10);
+        // Знімок вантажиться в окремий індекс і підміняє живий лише цілком:
+        // до SNAPSHOT_END запити бачать попередній стан, а обірваний знімок
+        // просто відкидається.
+        std::unique_ptr<IndexManager> staging;
+
+        Mutation mutation;
+        std::uint64_t seq = 0;
+        std::string error;
+        bool streamed = false;
+        while (reader.readLine(line)) {
+            streamed = true;
+            if (line.compare(0, 5, "PING ") == 0) {
+                continue;
+            }
+            if (line.compare(0, 9, "SNAPSHOT ") == 0) {
+                staging     = index.makeStaging();
+                leaderEpoch = 0;
+                continue;
+            }
+            if (line.compare(0, 13, "SNAPSHOT_END ") == 0) {
+                if (!staging) {
+                    std::cerr << "Replication stream error: SNAPSHOT_END without SNAPSHOT\n";
+                    return false;
+                }
+                index.adoptState(*staging);
+                staging.reset();
+                leaderEpoch = offeredEpoch;
+                setApplied(std::strtoull(line.c_str() + 13, nullptr, 10));
+                snapshots.add();
+                continue;
+            }
+            if (!MutationLog::decode(line, reader, mutation, seq, error)) {
+                std::cerr << "Replication stream error: " << error << "\n";
+                return false;
+            }
+            if (staging) {
+                staging->applyMutation(mutation);
+            } else {
+                index.applyMutation(mutation);
+                setApplied(seq);
+            }
+        }
+        return streamed;
+    }
+
+    void setApplied(std::uint64_t seq) {
+        applied.store(seq);
+        appliedSeqGauge.set(static_cast<std::int64_t>(seq));
+    }
+
+private:
+    IndexManager&              index;
+    std::string                leaderIp;
+    int                        leaderPort;
+    std::uint64_t              leaderEpoch;
+    std::atomic<std::uint64_t> applied;
+    std::atomic<std::uint64_t> connects;
+    bool                       stopping;
+    SocketHandle               activeSocket;
+    std::mutex                 mutex;
+    std::condition_variable    wakeUp;
+    std::thread                worker;
+    metrics::Gauge&            appliedSeqGauge;
+    metrics::Counter&          snapshots;
+    metrics::Counter&          reconnects;
+};
+
+} // namespace replication
+
+#endif
@@ -6,27 +6,39 @@
 #include <thread>
 #include <iostream>
 #include <sstream>
-
-#include "IndexManager.h"
-#ifdef _WIN32
-    #include <winsock2.h>
-    #include <ws2tcpip.h>
-    #pragma comment(lib, "Ws2_32.lib")
-#else
-    #include <sys/types.h>
-    #include <sys/socket.h>
-    #include <netinet/in.h>
-    #include <arpa/inet.h>
-    #include <unistd.h>
-    #define INVALID_SOCKET (-1)
-    #define SOCKET_ERROR   (-1)
-#endif
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <csignal>
+#include <cerrno>
+#include <cstdlib>
+#include <limits>
+
+#include "index_manager.h"
+#include "thread_pool.h"
+#include "metrics.h"
+#include "socket_platform.h"
+#include "shard_coordinator.h"
+#include "replication.h"
+#include "deadline.h"
 
 class Server {
 public:
-    Server()
+    explicit Server(unsigned int workerThreads = 0,
+                    WorkerPinning pinning = WorkerPinning::None,
+                    const NumaTopology& topology = NumaTopology::system())
         : listenSocket(INVALID_SOCKET)
-    {}
+        , stopping(false)
+        , coordinator(nullptr)
+        , replicationLeader(nullptr)
+        , readOnly(false)
+        , maxInFlight(0)
+        , requestTimeoutMs(0)
+        , admitted(0)
+        , threadPool(workerThreads, pinning, topology)
+    {
+        indexManager.setThreadPool(&threadPool);
+    }
 
     ~Server() {
         stop();
@@ -45,6 +57,10 @@ public:
             std::cerr << "WSAStartup failed: " << result << "\n";
             return false;
         }
+    #else
+        // Клієнт або фоловер, що відключився, не повинен вбивати процес через SIGPIPE:
+        // send() натомість поверне помилку.
+        std::signal(SIGPIPE, SIG_IGN);
     #endif
         return true;
     }
@@ -111,7 +127,8 @@ public:
     }
 
     void acceptLoop() {
-        if (listenSocket == INVALID_SOCKET) {
+        SocketHandle socketToAccept = listenSocket;
+        if (socketToAccept == INVALID_SOCKET) {
             std::cerr << "Server not initialized\n";
             return;
         }
@@ -124,21 +141,56 @@ public:
             socklen_t addrLen = sizeof(clientAddr);
         #endif
 
-            auto clientSocket = ::accept(listenSocket,
+            auto clientSocket = ::accept(socketToAccept,
                                          reinterpret_cast<sockaddr*>(&clientAddr),
                                          &addrLen);
             if (clientSocket == INVALID_SOCKET) {
-                std::cerr << "accept() failed\n";
+                if (!stopping.load()) {
+                    std::cerr << "accept() failed\n";
+                }
                 break;
             }
 
-            std::thread t(&Server::handleClient, this, clientSocket);
-            t.detach();
+            // Перевантаження: краще швидко відмовити частині клієнтів, ніж
+            // поставити в чергу всіх і зробити повільними всі відповіді.
+            std::size_t limit = maxInFlight.load();
+            if (limit > 0 && admitted.load() >= limit) {
+                admissionRejected().add();
+                rejectBusy(clientSocket);
+                continue;
+            }
+
+            auto acceptedAt = Deadline::Clock::now();
+            auto admission  = std::make_shared<Admission>(*this, clientSocket);
+            threadPool.post([this, admission, acceptedAt]() {
+                handleClient(*admission, acceptedAt);
+            });
         }
     }
 
+    // Фактичний порт (корисно, якщо initServer викликано з портом 0).
+    int boundPort() const {
+        sockaddr_in addr;
+    #ifdef _WIN32
+        int addrLen = sizeof(addr);
+    #else
+        socklen_t addrLen = sizeof(addr);
+    #endif
+        if (getsockname(listenSocket, reinterpret_cast<sockaddr*>(&addr), &addrLen) == SOCKET_ERROR) {
+            return -1;
+        }
+        return ntohs(addr.sin_port);
+    }
+
     void stop() {
+        stopping.store(true);
         if (listenSocket != INVALID_SOCKET) {
+            // shutdown() будить accept(), заблокований в іншому потоці.
+        #ifdef _WIN32
+            ::shutdown(listenSocket, SD_BOTH);
+        #else
+            ::shutdown(listenSocket, SHUT_RDWR);
+        #endif
             closeSocket(listenSocket);
             listenSocket = INVALID_SOCKET;
         }
@@ -148,111 +200,620 @@ public:
         return indexManager;
     }
 
+    ThreadPool& getThreadPool() {
+        return threadPool;
+    }
+
+    // Режим координатора: запити обслуговують шарди, а не власний IndexManager.
+    void setCoordinator(ShardCoordinator* shardCoordinator) {
+        coordinator = shardCoordinator;
+    }
+
+    // Режим лідера: з'єднання з REPLICATE передаються лідеру реплікації.
+    void setReplicationLeader(replication::Leader* leader) {
+        replicationLeader = leader;
+    }
+
+    // Репліка приймає лише пошукові запити: зміни приходять від лідера.
+    void setReadOnly(bool value) {
+        readOnly = value;
+    }
+
+    // Контроль навантаження (0 - без обмежень):
+    //   maxInFlight      - прийнятих, але ще не оброблених з'єднань; понад це - ERROR BUSY;
+    //   requestTimeoutMs - термін від accept() до кінця пошуку; після нього - ERROR TIMEOUT.
+    void setAdmissionLimits(std::size_t maxConnections, int timeoutMs) {
+        maxInFlight.store(maxConnections);
+        requestTimeoutMs.store(timeoutMs);
+    }
+
 private:
+    // Буферизований запис відповіді прямо в сокет: шляхи не збираються
+    // в один великий рядок, а відправляються шматками по kBufferSize.
+    class ResponseWriter {
+    public:
+        static constexpr std::size_t kBufferSize = 64 * 1024;
+
+        explicit ResponseWriter(SocketHandle s)
+            : socket(s)
+            , failed(false)
+        {
+            buffer.reserve(kBufferSize);
+        }
+
+        ~ResponseWriter() {
+            flush();
+        }
+
+        ResponseWriter(const ResponseWriter&)            = delete;
+        ResponseWriter& operator=(const ResponseWriter&) = delete;
+
+        void write(const std::string& text) {
+            write(text.data(), text.size());
+        }
+
+        void write(const char* data, std::size_t size) {
+            if (buffer.size() + size > kBufferSize) {
+                flush();
+            }
+            if (size >= kBufferSize) {
+                sendAll(data, size);
+                return;
+            }
+            buffer.append(data, size);
+        }
+
+        void flush() {
+            if (!buffer.empty()) {
+                sendAll(buffer.data(), buffer.size());
+                buffer.clear();
+            }
+        }
+
+        // Інтерфейс для IndexManager::materialize.
+        void begin(std::size_t count) {
+            write("OK " + std::to_string(count) + "\n");
+        }
+
+        void path(const std::string& p) {
+            write(p.data(), p.size());
+            write("\n", 1);
+        }
+
+    private:
+        void sendAll(const char* data, std::size_t size) {
+            while (!failed && size > 0) {
+                int sent = ::send(socket, data, static_cast<int>(size), 0);
+                if (sent <= 0) {
+                    failed = true;
+                    return;
+                }
+                data += sent;
+                size -= static_cast<std::size_t>(sent);
+            }
+        }
+
+        SocketHandle socket;
+        std::string  buffer;
+        bool         failed;
+    };
+
+    // Прийняте з'єднання: слот допуску й сокет звільняються в деструкторі, тож
+    // виняток в обробнику не залишає слот зайнятим назавжди.
+    class Admission {
+    public:
+        Admission(Server& owner, SocketHandle clientSocket)
+            : owner(owner)
+            , clientSocket(clientSocket)
+        {
+            owner.admitted.fetch_add(1);
+            connectionsInFlight().add(1);
+        }
+
+        // Слот звільняється до закриття сокета: клієнт, що одразу після
+        // відповіді під'єднується знову, не отримає ERROR BUSY від самого себе.
+        ~Admission() {
+            owner.admitted.fetch_sub(1);
+            connectionsInFlight().add(-1);
+            if (clientSocket != INVALID_SOCKET) {
+                closeSocketHandle(clientSocket);
+            }
+        }
+
+        Admission(const Admission&)            = delete;
+        Admission& operator=(const Admission&) = delete;
+        Admission(Admission&&)                 = delete;
+        Admission& operator=(Admission&&)      = delete;
+
+        SocketHandle socket() const {
+            return clientSocket;
+        }
+
+        // Сокет переходить іншому власнику (лідеру реплікації), слот звільняється як завжди.
+        SocketHandle release() {
+            SocketHandle s = clientSocket;
+            clientSocket   = INVALID_SOCKET;
+            return s;
+        }
+
+    private:
+        Server&      owner;
+        SocketHandle clientSocket;
+    };
+
+    void handleClient(Admission& admission, Deadline::Clock::time_point acceptedAt) {
+        int timeoutMs = requestTimeoutMs.load();
+        if (timeoutMs > 0) {
+            Deadline deadline(acceptedAt + std::chrono::milliseconds(timeoutMs));
+            serveClient(admission, deadline);
+        } else {
+            serveClient(admission, Deadline());
+        }
+    }
+
+    void serveClient(Admission& admission, const Deadline& deadline) {
+        SocketHandle clientSocket = admission.socket();
+        // Термін іде від accept(): з'єднання могло простояти більшу його частину
+        // в черзі пулу, тож recv() чекає лише залишок, а без залишку не читаємо.
+        long long remainingMs = deadline.remainingMs();
+        if (remainingMs == 0) {
+            requestTimeouts().add();
+            replyUnread(clientSocket, "ERROR TIMEOUT\n");
+            return;
+        }
+        setSocketReceiveTimeout(clientSocket, static_cast<int>(remainingMs));
 
-    void handleClient(
-    #ifdef _WIN32
-        SOCKET clientSocket
-    #else
-        int clientSocket
-    #endif
-    ) {
         char buffer[4096];
         int received = ::recv(clientSocket, buffer, sizeof(buffer) - 1, 0);
         if (received <= 0) {
-            closeSocket(clientSocket);
             return;
         }
         buffer[received] = '\0';
 
         std::string request(buffer);
-        std::string response = processRequest(request);
+        if (request.compare(0, 10, "REPLICATE ") == 0) {
+            startReplication(admission.release(), request);
+            return;
+        }
 
-        if (!response.empty()) {
-            ::send(clientSocket, response.c_str(),
-                   static_cast<int>(response.size()), 0);
+        ResponseWriter writer(clientSocket);
+        try {
+            processRequest(request, writer, deadline);
+        } catch (const std::exception&) {
+            writer.write("ERROR Internal error\n");
+        } catch (...) {
+            writer.write("ERROR Internal error\n");
         }
+    }
 
+    // Відмова без читання запиту - у потоці accept(), тож має бути дешевою.
+    void rejectBusy(SocketHandle clientSocket) {
+        replyUnread(clientSocket, "ERROR BUSY\n");
         closeSocket(clientSocket);
     }
 
-    std::string processRequest(const std::string& request) {
+    // Відповідь без читання запиту; сокет закриває викликач.
+    static void replyUnread(SocketHandle clientSocket, const std::string& reply) {
+        ::send(clientSocket, reply.data(), static_cast<int>(reply.size()), 0);
+    #ifdef _WIN32
+        ::shutdown(clientSocket, SD_SEND);
+    #else
+        ::shutdown(clientSocket, SHUT_WR);
+        // Непрочитаний запит у буфері змусив би close() надіслати RST,
+        // і клієнт міг би не встигнути прочитати відповідь.
+        char drain[4096];
+        while (::recv(clientSocket, drain, sizeof(drain), MSG_DONTWAIT) > 0) {
+        }
+    #endif
+    }
+
+    // REPLICATE <epoch> <nextSeq>: сокет переходить у власність лідера реплікації.
+    void startReplication(SocketHandle clientSocket, const std::string& request) {
+        std::istringstream iss(request);
+        std::string command;
+        std::uint64_t epoch   = 0;
+        std::uint64_t nextSeq = 0;
+        if (replicationLeader == nullptr || !(iss >> command >> epoch >> nextSeq)) {
+            {
+                ResponseWriter writer(clientSocket);
+                writer.write(replicationLeader == nullptr ? "ERROR Not a replication leader\n"
+                                                          : "ERROR Usage: REPLICATE <epoch> <seq>\n");
+            }
+            closeSocket(clientSocket);
+            return;
+        }
+        replicationLeader->serve(clientSocket, epoch, nextSeq);
+    }
+
+    void processRequest(const std::string& request, ResponseWriter& out, const Deadline& deadline) {
         std::istringstream iss(request);
         std::string command;
         iss >> command;
 
+        CommandMetrics& cm = commandMetrics(command);
+        metrics::ScopedTimer timer(cm.latency);
+
+        std::vector<std::string> args;
+        std::string arg;
+        while (iss >> arg) {
+            args.push_back(arg);
+        }
+
+        bool ok = false;
+        if (deadline.expired()) {
+            // Запит простояв у черзі весь свій термін - не починаємо роботу.
+            requestTimeouts().add();
+            out.write("ERROR TIMEOUT\n");
+        } else {
+            ok = dispatchRequest(command, args, out, deadline);
+        }
+
+        (ok ? cm.ok : cm.error).add();
+    }
+
+    // Повертає false, якщо клієнту відправлено ERROR.
+    bool dispatchRequest(const std::string& command,
+                         std::vector<std::string>& args,
+                         ResponseWriter& out,
+                         const Deadline& deadline) {
+        if (isFileCommand(command)) {
+            if (args.empty()) {
+                out.write("ERROR Missing path for " + command + "\n");
+                return false;
+            }
+            if (readOnly && command != "HAS_FILE") {
+                out.write("ERROR Read-only replica\n");
+                return false;
+            }
+            std::string docPath = joinArgs(args);
+            return coordinator != nullptr ? forwardFileCommand(command, docPath, out, deadline)
+                                          : handleFileCommand(command, docPath, out);
+        }
+
+        if (coordinator != nullptr && command != "STATS") {
+            return dispatchToShards(command, args, out, deadline);
+        }
+
+        ResultWindow window;
+        std::string optionError;
+        if (!parseResultWindow(args, window, optionError)) {
+            out.write("ERROR " + optionError + "\n");
+            return false;
+        }
+
         if (command == "SEARCH_ONE") {
-            std::string word;
-            iss >> word;
-            if (word.empty()) {
-                return "ERROR Missing word for SEARCH_ONE\n";
+            if (args.empty()) {
+                out.write("ERROR Missing word for SEARCH_ONE\n");
+                return false;
             }
 
-            std::vector<std::string> results;
-            bool found = indexManager.searchSingleWord(word, results);
-            return formatSearchResponse(found, results);
+            std::vector<unsigned int> docIds;
+            indexManager.findSingleWord(args.front(), docIds, deadline);
+            return writeSearchResponse(docIds, window, deadline, out);
         }
 
         if (command == "SEARCH_ALL" || command == "SEARCH_ANY") {
-            std::vector<std::string> words;
-            std::string w;
-            while (iss >> w) {
-                words.push_back(w);
-            }
-            if (words.empty()) {
-                return "ERROR No words provided\n";
+            if (args.empty()) {
+                out.write("ERROR No words provided\n");
+                return false;
             }
 
-            std::vector<std::string> results;
-            bool found = false;
+            std::vector<unsigned int> docIds;
             if (command == "SEARCH_ALL") {
-                found = indexManager.searchAllWords(words, results);
+                indexManager.findAllWords(args, docIds, deadline);
             } else {
-                found = indexManager.searchAnyWord(words, results);
+                indexManager.findAnyWord(args, docIds, deadline);
             }
-            return formatSearchResponse(found, results);
+            return writeSearchResponse(docIds, window, deadline, out);
         }
 
-        return "ERROR Unknown command\n";
+        if (command == "QUERY") {
+            if (args.empty()) {
+                out.write("ERROR Missing expression for QUERY\n");
+                return false;
+            }
+
+            std::vector<unsigned int> docIds;
+            std::string error;
+            indexManager.findQuery(joinArgs(args), docIds, error, deadline);
+            if (!error.empty()) {
+                out.write("ERROR " + error + "\n");
+                return false;
+            }
+            return writeSearchResponse(docIds, window, deadline, out);
+        }
+
+        if (command == "STATS") {
+            writeStats(!args.empty() && args.front() == "PROMETHEUS", out);
+            return true;
+        }
+
+        out.write("ERROR Unknown command\n");
+        return false;
+    }
+
+    static bool isFileCommand(const std::string& command) {
+        return command == "ADD_FILE" || command == "REMOVE_FILE"
+            || command == "REINDEX_FILE" || command == "HAS_FILE";
     }
 
-    std::string formatSearchResponse(bool found,
-                                     const std::vector<std::string>& results) {
-        if (!found || results.empty()) {
-            return "OK 0\nEND\n";
+    // Шлях може містити пробіли: беремо весь залишок запиту.
+    static std::string joinArgs(const std::vector<std::string>& args) {
+        std::string joined;
+        for (std::size_t i = 0; i < args.size(); ++i) {
+            if (i > 0) {
+                joined += ' ';
+            }
+            joined += args[i];
+        }
+        return joined;
+    }
+
+    // ADD_FILE / REINDEX_FILE / REMOVE_FILE -> OK | ERROR ...; HAS_FILE -> OK 1 | OK 0.
+    bool handleFileCommand(const std::string& command, const std::string& docPath, ResponseWriter& out) {
+        if (command == "HAS_FILE") {
+            unsigned int docId = 0;
+            out.write(indexManager.hasFile(docPath, docId) ? "OK 1\n" : "OK 0\n");
+            return true;
+        }
+
+        bool ok = false;
+        if (command == "ADD_FILE") {
+            ok = indexManager.addFile(docPath);
+        } else if (command == "REINDEX_FILE") {
+            ok = indexManager.reindexFile(docPath);
+        } else {
+            ok = indexManager.removeFile(docPath);
         }
 
-        std::ostringstream oss;
-        oss << "OK " << results.size() << "\n";
-        for (const std::string& path : results) {
-            oss << path << "\n";
+        if (!ok) {
+            out.write(command == "REMOVE_FILE" ? "ERROR File is not indexed\n" : "ERROR Cannot read file\n");
+            return false;
         }
-        oss << "END\n";
-        return oss.str();
+        out.write("OK\n");
+        return true;
     }
 
-    void closeSocket(
-    #ifdef _WIN32
-        SOCKET s
-    #else
-        int s
-    #endif
-    ) {
-    #ifdef _WIN32
-        ::closesocket(s);
-    #else
-        ::close(s);
-    #endif
+    bool forwardFileCommand(const std::string& command,
+                            const std::string& docPath,
+                            ResponseWriter& out,
+                            const Deadline& deadline) {
+        std::string response;
+        std::string error;
+        if (!coordinator->forward(docPath, command + " " + docPath, response, error, deadline)) {
+            out.write("ERROR " + error + "\n");
+            return false;
+        }
+        out.write(response);
+        return response.compare(0, 2, "OK") == 0;
+    }
+
+    // Пошук у режимі координатора. Частковий результат: "OK n PARTIAL failed/total".
+    bool dispatchToShards(const std::string& command,
+                          std::vector<std::string>& args,
+                          ResponseWriter& out,
+                          const Deadline& deadline) {
+        if (command != "SEARCH_ONE" && command != "SEARCH_ALL"
+            && command != "SEARCH_ANY" && command != "QUERY") {
+            out.write("ERROR Unknown command\n");
+            return false;
+        }
+
+        ResultWindow window;
+        std::string optionError;
+        if (!parseResultWindow(args, window, optionError)) {
+            out.write("ERROR " + optionError + "\n");
+            return false;
+        }
+        if (args.empty()) {
+            out.write("ERROR Missing arguments for " + command + "\n");
+            return false;
+        }
+
+        ShardCoordinator::SearchResult result;
+        bool answered = coordinator->search(command + " " + joinArgs(args), window, result, deadline);
+        if (deadline.expired()) {
+            requestTimeouts().add();
+            out.write("ERROR TIMEOUT\n");
+            return false;
+        }
+        if (!answered) {
+            out.write("ERROR " + result.error + "\n");
+            return false;
+        }
+
+        std::string header = "OK " + std::to_string(result.paths.size());
+        if (result.failedShards > 0) {
+            header += " PARTIAL " + std::to_string(result.failedShards)
+                    + "/" + std::to_string(coordinator->shardCount());
+        }
+        out.write(header + "\n");
+        for (const std::string& p : result.paths) {
+            out.path(p);
+        }
+        out.write("END\n");
+        return true;
+    }
+
+    // STATS           - короткий звіт (p50/p99/p999 у мікросекундах);
+    // STATS PROMETHEUS - текстовий формат Prometheus.
+    void writeStats(bool prometheus, ResponseWriter& out) {
+        metrics::Registry& r = metrics::registry();
+
+        r.gauge("cw_index_words", "Distinct words in the index").set(indexManager.wordCount());
+        r.gauge("cw_index_documents", "Indexed documents").set(indexManager.documentCount());
+        r.gauge("cw_index_posting_bytes", "Approximate memory used by posting lists")
+            .set(static_cast<std::int64_t>(indexManager.postingMemoryUsage()));
+        r.gauge("cw_pool_pending_tasks", "Tasks queued in the thread pool")
+            .set(static_cast<std::int64_t>(threadPool.pendingTasks()));
+
+        std::vector<ThreadPool::WorkerStats> workers = threadPool.getWorkerStats();
+        for (std::size_t i = 0; i < workers.size(); ++i) {
+            std::string label = "worker=\"" + std::to_string(i) + "\"";
+            r.counter("cw_pool_tasks_executed_total", "Tasks executed by a pool worker", label)
+                .raiseTo(workers[i].executed);
+            r.counter("cw_pool_tasks_stolen_total", "Tasks a pool worker stole from others", label)
+                .raiseTo(workers[i].stolen);
+            r.gauge("cw_pool_worker_numa_node", "NUMA node a pool worker is pinned to (-1: unpinned)", label)
+                .set(workers[i].node);
+        }
+
+        std::vector<std::string> lines;
+        if (prometheus) {
+            std::istringstream text(r.renderPrometheus());
+            std::string line;
+            while (std::getline(text, line)) {
+                lines.push_back(line);
+            }
+        } else {
+            lines = r.renderSummary();
+        }
+
+        out.write("OK " + std::to_string(lines.size()) + "\n");
+        for (const std::string& line : lines) {
+            out.write(line + "\n");
+        }
+        out.write("END\n");
+    }
+
+    // Необов'язкові параметри в кінці запиту: LIMIT n, OFFSET n, ORDER PATH|DOCID.
+    // Слово LIMIT/OFFSET/ORDER вважається параметром лише після хоча б одного
+    // терма і з коректним аргументом; інакше це звичайне слово пошуку.
+    static bool parseResultWindow(std::vector<std::string>& args,
+                                  ResultWindow& window,
+                                  std::string& outError) {
+        while (args.size() >= 3) {
+            const std::string& key   = args[args.size() - 2];
+            const std::string& value = args[args.size() - 1];
+
+            if (key == "LIMIT" || key == "OFFSET") {
+                if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos) {
+                    break;
+                }
+                std::size_t number = 0;
+                if (!parseCount(value, number)) {
+                    outError = "Invalid value for " + key;
+                    return false;
+                }
+                if (key == "LIMIT") {
+                    window.limit = number;
+                } else {
+                    window.offset = number;
+                }
+            } else if (key == "ORDER" && (value == "PATH" || value == "DOCID")) {
+                window.order = value == "PATH" ? ResultOrder::ByPath : ResultOrder::ByDocId;
+            } else {
+                break;
+            }
+
+            args.pop_back();
+            args.pop_back();
+        }
+        return true;
+    }
+
+    // Десяткове число без знака; false, якщо не вміщується в size_t.
+    static bool parseCount(const std::string& text, std::size_t& outValue) {
+        errno = 0;
+        char* end = nullptr;
+        unsigned long long value = std::strtoull(text.c_str(), &end, 10);
+        if (errno == ERANGE || end == text.c_str() || *end != '\0'
+            || value > static_cast<unsigned long long>(std::numeric_limits<std::size_t>::max())) {
+            return false;
+        }
+        outValue = static_cast<std::size_t>(value);
+        return true;
+    }
+
+    // false і ERROR TIMEOUT, якщо пошук перервано терміном запиту.
+    bool writeSearchResponse(const std::vector<unsigned int>& docIds,
+                             const ResultWindow& window,
+                             const Deadline& deadline,
+                             ResponseWriter& out) {
+        if (deadline.expired()) {
+            requestTimeouts().add();
+            out.write("ERROR TIMEOUT\n");
+            return false;
+        }
+        indexManager.materialize(docIds, window, out);
+        out.write("END\n");
+        return true;
+    }
+
+    struct CommandMetrics {
+        metrics::Counter&          ok;
+        metrics::Counter&          error;
+        metrics::LatencyHistogram& latency;
+    };
+
+    static metrics::Gauge& connectionsInFlight() {
+        static metrics::Gauge& g = metrics::registry().gauge("cw_connections_in_flight",
+                                                             "Accepted connections not yet answered");
+        return g;
+    }
+
+    static metrics::Counter& admissionRejected() {
+        static metrics::Counter& c = metrics::registry().counter("cw_requests_rejected_total",
+                                                                 "Connections refused with ERROR BUSY");
+        return c;
+    }
+
+    static metrics::Counter& requestTimeouts() {
+        static metrics::Counter& c = metrics::registry().counter("cw_requests_timed_out_total",
+                                                                 "Requests answered with ERROR TIMEOUT");
+        return c;
+    }
+
+    static CommandMetrics& commandMetrics(const std::string& command) {
+        static CommandMetrics searchOne = makeCommandMetrics("SEARCH_ONE");
+        static CommandMetrics searchAll = makeCommandMetrics("SEARCH_ALL");
+        static CommandMetrics searchAny = makeCommandMetrics("SEARCH_ANY");
+        static CommandMetrics query     = makeCommandMetrics("QUERY");
+        static CommandMetrics stats     = makeCommandMetrics("STATS");
+        static CommandMetrics addFile   = makeCommandMetrics("ADD_FILE");
+        static CommandMetrics remove    = makeCommandMetrics("REMOVE_FILE");
+        static CommandMetrics reindex   = makeCommandMetrics("REINDEX_FILE");
+        static CommandMetrics hasFile   = makeCommandMetrics("HAS_FILE");
+        static CommandMetrics unknown   = makeCommandMetrics("UNKNOWN");
+
+        if (command == "SEARCH_ONE")   return searchOne;
+        if (command == "SEARCH_ALL")   return searchAll;
+        if (command == "SEARCH_ANY")   return searchAny;
+        if (command == "QUERY")        return query;
+        if (command == "STATS")        return stats;
+        if (command == "ADD_FILE")     return addFile;
+        if (command == "REMOVE_FILE")  return remove;
+        if (command == "REINDEX_FILE") return reindex;
+        if (command == "HAS_FILE")     return hasFile;
+        return unknown;
+    }
+
+    static CommandMetrics makeCommandMetrics(const std::string& command) {
+        metrics::Registry& r = metrics::registry();
+        std::string label = "command=\"" + command + "\"";
+        return CommandMetrics{
+            r.counter("cw_commands_total", "Processed commands", label + ",status=\"ok\""),
+            r.counter("cw_commands_total", "Processed commands", label + ",status=\"error\""),
+            r.histogram("cw_command_duration_seconds", "End-to-end command latency", label)
+        };
+    }
+
+    void closeSocket(SocketHandle s) {
+        closeSocketHandle(s);
     }
 
 private:
-#ifdef _WIN32
-    SOCKET listenSocket;
-#else
-    int listenSocket;
-#endif
+    SocketHandle             listenSocket;
+    std::atomic<bool>        stopping;
+    ShardCoordinator*        coordinator;
+    replication::Leader*     replicationLeader;
+    bool                     readOnly;
+    std::atomic<std::size_t> maxInFlight;
+    std::atomic<int>         requestTimeoutMs;
+    std::atomic<std::size_t> admitted;
 
     IndexManager indexManager;
+    ThreadPool   threadPool;
 };
 
 #endif
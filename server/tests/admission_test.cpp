@@ -0,0 +1,141 @@
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "server.h"
+#include "test_check.h"
+
+// Контроль навантаження сервера на localhost: ERROR BUSY понад ліміт
+// з'єднань і ERROR TIMEOUT для з'єднання, що вичерпало термін у черзі пулу.
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// Сире з'єднання: тест сам вирішує, коли (і чи) надсилати запит.
+class Connection {
+public:
+    explicit Connection(int port)
+        : s(::socket(AF_INET, SOCK_STREAM, 0))
+    {
+        setSocketTimeout(s, 5000);
+        sockaddr_in addr;
+        addr.sin_family      = AF_INET;
+        addr.sin_port        = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+        connected = ::connect(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != SOCKET_ERROR;
+    }
+
+    ~Connection() {
+        closeSocketHandle(s);
+    }
+
+    Connection(const Connection&)            = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    bool send(const std::string& request) {
+        return ::send(s, request.data(), static_cast<int>(request.size()), 0)
+            == static_cast<int>(request.size());
+    }
+
+    // Відповідь до закриття з'єднання сервером.
+    std::string readAll() {
+        std::string response;
+        char buffer[4096];
+        for (;;) {
+            int received = ::recv(s, buffer, sizeof(buffer), 0);
+            if (received <= 0) {
+                return response;
+            }
+            response.append(buffer, static_cast<std::size_t>(received));
+        }
+    }
+
+    bool connected;
+
+private:
+    SocketHandle s;
+};
+
+class RunningServer {
+public:
+    RunningServer(std::size_t maxConnections, int timeoutMs)
+        : server(1)
+    {
+        server.setAdmissionLimits(maxConnections, timeoutMs);
+        CHECK(server.initServer("127.0.0.1", 0));
+        thread = std::thread([this]() { server.acceptLoop(); });
+    }
+
+    ~RunningServer() {
+        server.stop();
+        thread.join();
+    }
+
+    RunningServer(const RunningServer&)            = delete;
+    RunningServer& operator=(const RunningServer&) = delete;
+
+    int port() const {
+        return server.boundPort();
+    }
+
+private:
+    Server      server;
+    std::thread thread;
+};
+
+// Ліміт в одне з'єднання: поки перше не відповіло, друге отримує ERROR BUSY.
+void testBusy() {
+    RunningServer running(1, 0);
+    Connection first(running.port());
+    CHECK(first.connected);
+    // Перше з'єднання прийняте й займає слот, доки не надішле запит.
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    Connection second(running.port());
+    CHECK(second.connected);
+    CHECK(second.send("SEARCH_ONE word\n"));
+    CHECK(second.readAll() == "ERROR BUSY\n");
+
+    CHECK(first.send("SEARCH_ONE word\n"));
+    CHECK(first.readAll().compare(0, 5, "ERROR") != 0);
+
+    // Слот звільнено: наступне з'єднання обслуговується.
+    Connection third(running.port());
+    CHECK(third.send("SEARCH_ONE word\n"));
+    CHECK(third.readAll().compare(0, 5, "ERROR") != 0);
+}
+
+// Один воркер зайнятий мовчазним клієнтом, друге з'єднання чекає в черзі весь
+// свій термін. Воно отримує ERROR TIMEOUT одразу, без ще одного recv() на
+// повний тайм-аут, і навіть не надіславши запиту.
+void testTimeoutInQueue() {
+    const int kTimeoutMs = 300;
+    RunningServer running(0, kTimeoutMs);
+
+    Clock::time_point start = Clock::now();
+    Connection silent(running.port());
+    Connection queued(running.port());
+    CHECK(silent.connected && queued.connected);
+
+    CHECK(queued.readAll() == "ERROR TIMEOUT\n");
+    long long elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
+    CHECK(elapsedMs >= kTimeoutMs);
+    CHECK(elapsedMs < 2 * kTimeoutMs);
+    // Мовчазний клієнт просто від'єднаний після свого терміну.
+    CHECK(silent.readAll().empty());
+
+    // Вчасний запит обслуговується як звичайно.
+    Connection timely(running.port());
+    CHECK(timely.send("SEARCH_ONE word\n"));
+    CHECK(timely.readAll().compare(0, 5, "ERROR") != 0);
+}
+
+} // namespace
+
+int main() {
+    CHECK(Server::initSockets());
+    testBusy();
+    testTimeoutInQueue();
+    return test::result("admission_test");
+}
@@ -0,0 +1,96 @@
+#include <string>
+#include <vector>
+
+#include "utf8.h"
+#include "analyzer.h"
+#include "test_check.h"
+
+// UTF-8 та ланки аналізатора. Очікування задано явними конфігураціями,
+// тож результат не залежить від CW_ANALYZER.
+
+namespace {
+
+typedef std::vector<std::string> Terms;
+
+void testDecode() {
+    const std::string text = "a\xD0\x96\xE2\x82\xAC\xF0\x9F\x98\x80";    // a Ж € 😀
+    const char* p   = text.data();
+    const char* end = p + text.size();
+    char32_t cp = 0;
+
+    CHECK(utf8::decode(p, end, cp) == 1 && cp == 'a');
+    p += 1;
+    CHECK(utf8::decode(p, end, cp) == 2 && cp == 0x416);
+    p += 2;
+    CHECK(utf8::decode(p, end, cp) == 3 && cp == 0x20AC);
+    p += 3;
+    CHECK(utf8::decode(p, end, cp) == 4 && cp == 0x1F600);
+
+    // Обрізана, надлишкова і сурогатна послідовності.
+    const std::string bad[] = {"\xD0", "\xC0\xAF", "\xED\xA0\x80", "\x80"};
+    for (const std::string& s : bad) {
+        CHECK(utf8::decode(s.data(), s.data() + s.size(), cp) == 1 && cp == utf8::kReplacement);
+    }
+
+    std::string out;
+    utf8::append(out, 0x416);
+    utf8::append(out, 0x1F600);
+    CHECK(out == "\xD0\x96\xF0\x9F\x98\x80");
+    CHECK(utf8::length("київ") == 4);
+}
+
+void testFoldCase() {
+    CHECK(utf8::foldCase('Q') == 'q');
+    CHECK(utf8::foldCase(0x416) == 0x436);     // Ж -> ж
+    CHECK(utf8::foldCase(0x404) == 0x454);     // Є -> є
+    CHECK(utf8::foldCase(0x407) == 0x457);     // Ї -> ї
+    CHECK(utf8::foldCase(0x490) == 0x491);     // Ґ -> ґ
+    CHECK(utf8::foldCase(0x3A3) == 0x3C3);     // Σ -> σ
+    CHECK(utf8::foldCase(0xC9) == 0xE9);       // É -> é
+    CHECK(utf8::foldCase(0xD7) == 0xD7);       // ×
+}
+
+void testTokenizers() {
+    CHECK(analysis::AsciiAnalyzer::terms("Hello, World! 42") == (Terms{"hello", "world", "42"}));
+    // У режимі ASCII весь UTF-8 - роздільник.
+    CHECK(analysis::AsciiAnalyzer::terms("caf\xC3\xA9 bar") == (Terms{"caf", "bar"}));
+
+    CHECK(analysis::UnicodeAnalyzer::terms("Київ, ЛЬВІВ") == (Terms{"київ", "львів"}));
+    CHECK(analysis::UnicodeAnalyzer::terms("м'ясо don\xE2\x80\x99t") == (Terms{"м'ясо", "don't"}));
+    CHECK(analysis::UnicodeAnalyzer::terms("'quoted' a''b") == (Terms{"quoted", "a", "b"}));
+    CHECK(analysis::UnicodeAnalyzer::terms("foo-bar\xE2\x80\x94" "baz") == (Terms{"foo", "bar", "baz"}));
+    // Розкладене й (и + U+0306) і м'який перенос усередині слова.
+    CHECK(analysis::UnicodeAnalyzer::terms("\xD0\xB8\xCC\x86ти") == (Terms{"йти"}));
+    CHECK(analysis::UnicodeAnalyzer::terms("пере\xC2\xADнос") == (Terms{"перенос"}));
+    CHECK(analysis::UnicodeAnalyzer::terms("emoji\xF0\x9F\x98\x80here") == (Terms{"emoji", "here"}));
+    CHECK(analysis::UnicodeAnalyzer::terms(" ,.;!? ").empty());
+}
+
+void testUkrainian() {
+    CHECK(analysis::UkrainianAnalyzer::terms("та і Київ") == (Terms{"київ"}));
+    CHECK(analysis::UkrainianAnalyzer::terms("книгами книгою") == (Terms{"книг", "книг"}));
+    // Короткі основи та латиниця не змінюються.
+    CHECK(analysis::UkrainianAnalyzer::terms("сон dogs") == (Terms{"сон", "dogs"}));
+    CHECK(analysis::UkrainianAnalyzer::terms("що та й").empty());
+
+    // Ті самі ланки для документа й запиту.
+    Terms document = analysis::UkrainianAnalyzer::terms("Пошук книгами");
+    Terms query    = analysis::UkrainianAnalyzer::terms("КНИГАМИ");
+    CHECK(query.size() == 1 && document.back() == query.front());
+
+    // Порожня ланка не читає token[0].
+    std::string empty;
+    CHECK(!analysis::UkrainianStopwords::isStopword(empty));
+    analysis::UkrainianStemmer::stem(empty);
+    CHECK(empty.empty());
+}
+
+} // namespace
+
+int main() {
+    testDecode();
+    testFoldCase();
+    testTokenizers();
+    testUkrainian();
+    return test::result("analyzer_test");
+}
@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "server.h"
+#include "test_check.h"
+
+// Координатор шардів: розбір адрес і відповідей шардів, злиття сторінок,
+// потім scatter-gather над двома шардами на localhost, зокрема з
+// недоступним третім.
+
+namespace {
+
+typedef std::vector<std::string>                      Paths;
+typedef std::vector<const std::vector<std::string>*> Lists;
+
+ResultWindow makeWindow(std::size_t offset, std::size_t limit) {
+    ResultWindow window;
+    window.offset = offset;
+    window.limit  = limit;
+    return window;
+}
+
+void testParseEndpoints() {
+    std::vector<ShardEndpoint> endpoints;
+    std::string error;
+    CHECK(ShardCoordinator::parseEndpoints("127.0.0.1:7001,host-b:80", endpoints, error));
+    CHECK(endpoints.size() == 2);
+    CHECK(endpoints[0].ip == "127.0.0.1" && endpoints[0].port == 7001);
+    CHECK(endpoints[1].ip == "host-b" && endpoints[1].port == 80);
+
+    for (const char* bad : {"", "host", ":80", "host:", "host:8o", "a:1,,b:2", "a:1,"}) {
+        CHECK(!ShardCoordinator::parseEndpoints(bad, endpoints, error));
+        CHECK(!error.empty());
+    }
+}
+
+void testParseSearchResponse() {
+    Paths paths;
+    std::string error;
+    CHECK(ShardCoordinator::parseSearchResponse("OK 2\n/a\n/b c\nEND\n", paths, error));
+    CHECK(paths == (Paths{"/a", "/b c"}));
+    CHECK(ShardCoordinator::parseSearchResponse("OK 0\nEND\n", paths, error) && paths.empty());
+
+    CHECK(!ShardCoordinator::parseSearchResponse("ERROR Missing ')'\n", paths, error));
+    CHECK(error == "Missing ')'");
+    CHECK(!ShardCoordinator::parseSearchResponse("OK 2\n/a\n/b\n", paths, error));
+    CHECK(error == "Truncated shard response");
+    CHECK(!ShardCoordinator::parseSearchResponse("OK 1\n/a\nEN", paths, error));
+    CHECK(!ShardCoordinator::parseSearchResponse("OK 1", paths, error));
+    CHECK(!ShardCoordinator::parseSearchResponse("BUSY\n", paths, error));
+    CHECK(error == "Unexpected shard response");
+}
+
+void testMerge() {
+    Paths a = {"/a", "/d", "/e"};
+    Paths b = {"/b", "/c", "/f", "/g"};
+    Paths empty;
+    Lists lists = {&a, &empty, &b};
+    const std::size_t kAll = static_cast<std::size_t>(-1);
+
+    Paths out;
+    ShardCoordinator::mergeByPath(lists, makeWindow(0, kAll), out);
+    CHECK(out == (Paths{"/a", "/b", "/c", "/d", "/e", "/f", "/g"}));
+
+    out.clear();
+    ShardCoordinator::mergeByPath(lists, makeWindow(2, 3), out);
+    CHECK(out == (Paths{"/c", "/d", "/e"}));
+
+    // offset + limit переповнює size_t, offset за межами, limit = 0.
+    out.clear();
+    ShardCoordinator::mergeByPath(lists, makeWindow(5, kAll), out);
+    CHECK(out == (Paths{"/f", "/g"}));
+    out.clear();
+    ShardCoordinator::mergeByPath(lists, makeWindow(7, 1), out);
+    CHECK(out.empty());
+    ShardCoordinator::mergeByPath(lists, makeWindow(0, 0), out);
+    CHECK(out.empty());
+
+    // Порядок docId: шарди по черзі.
+    ShardCoordinator::collectConcatenated(lists, makeWindow(0, kAll), out);
+    CHECK(out == (Paths{"/a", "/d", "/e", "/b", "/c", "/f", "/g"}));
+    out.clear();
+    ShardCoordinator::collectConcatenated(lists, makeWindow(2, 3), out);
+    CHECK(out == (Paths{"/e", "/b", "/c"}));
+    out.clear();
+    ShardCoordinator::collectConcatenated(lists, makeWindow(kAll, kAll), out);
+    CHECK(out.empty());
+}
+
+class ShardProcess {
+public:
+    ShardProcess()
+        : server(2)
+    {
+        CHECK(server.initServer("127.0.0.1", 0));
+        thread = std::thread([this]() { server.acceptLoop(); });
+    }
+
+    ~ShardProcess() {
+        server.stop();
+        thread.join();
+    }
+
+    ShardProcess(const ShardProcess&)            = delete;
+    ShardProcess& operator=(const ShardProcess&) = delete;
+
+    ShardEndpoint endpoint() {
+        ShardEndpoint e;
+        e.ip   = "127.0.0.1";
+        e.port = server.boundPort();
+        return e;
+    }
+
+    Server server;
+
+private:
+    std::thread thread;
+};
+
+void testScatterGather(const std::filesystem::path& dir) {
+    CHECK(Server::initSockets());
+    ShardProcess shardA;
+    ShardProcess shardB;
+    ThreadPool pool(2);
+    ShardCoordinator coordinator({shardA.endpoint(), shardB.endpoint()}, pool, 2000);
+
+    Paths all;
+    for (int i = 0; i < 12; ++i) {
+        std::filesystem::path path = dir / ("doc" + std::to_string(i) + ".txt");
+        std::ofstream(path) << "common " << (i % 3 == 0 ? "three" : "other") << "\n";
+        all.push_back(path.string());
+    }
+    CHECK(coordinator.addFiles(all) == all.size());
+    // Кожен документ - рівно в одному шарді, і шарди не порожні.
+    std::size_t countA = shardA.server.getIndexManager().documentCount();
+    std::size_t countB = shardB.server.getIndexManager().documentCount();
+    CHECK(countA + countB == all.size() && countA > 0 && countB > 0);
+    std::sort(all.begin(), all.end());
+
+    ShardCoordinator::SearchResult result;
+    CHECK(coordinator.search("SEARCH_ONE common", ResultWindow(), result));
+    CHECK(result.paths == all && result.failedShards == 0);
+
+    CHECK(coordinator.search("SEARCH_ONE common", makeWindow(3, 4), result));
+    CHECK(result.paths == Paths(all.begin() + 3, all.begin() + 7));
+
+    CHECK(coordinator.search("QUERY three AND NOT other", ResultWindow(), result));
+    CHECK(result.paths.size() == 4);
+
+    // Помилку розбору повертає сам шард - її й отримує клієнт.
+    CHECK(!coordinator.search("QUERY (three", ResultWindow(), result));
+    CHECK(result.error == "Missing ')'");
+
+    // Вичерпаний термін: жоден шард не опитується.
+    Deadline expired(Deadline::Clock::now() - std::chrono::milliseconds(1));
+    CHECK(!coordinator.search("SEARCH_ONE common", ResultWindow(), result, expired));
+    CHECK(result.error == "All shards unavailable");
+
+    // Третій шард недоступний: відповідь часткова, але повна за живими шардами.
+    ShardEndpoint dead;
+    dead.ip   = "127.0.0.1";
+    dead.port = 1;
+    ShardCoordinator partial({shardA.endpoint(), shardB.endpoint(), dead}, pool, 500);
+    CHECK(partial.search("SEARCH_ONE common", ResultWindow(), result));
+    CHECK(result.failedShards == 1 && result.paths == all);
+
+    std::string response;
+    std::string error;
+    CHECK(coordinator.forward(all.front(), "HAS_FILE " + all.front(), response, error));
+    CHECK(response.compare(0, 2, "OK") == 0);
+}
+
+} // namespace
+
+int main() {
+    testParseEndpoints();
+    testParseSearchResponse();
+    testMerge();
+
+    std::filesystem::path dir = std::filesystem::temp_directory_path()
+                              / ("cw_cluster_test_" + std::to_string(std::random_device()()));
+    std::filesystem::create_directories(dir);
+    testScatterGather(dir);
+    std::filesystem::remove_all(dir);
+    return test::result("cluster_test");
+}
@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "doc_path_table.h"
+#include "index_manager.h"
+#include "test_check.h"
+
+// Матеріалізація результатів: DocPathTable під одночасними читачами й
+// замінами (вказівники під ReadGuard дійсні, старі рядки зрештою звільняються)
+// і вікно LIMIT / OFFSET / ORDER у IndexManager::materialize.
+
+namespace {
+
+std::string pathOf(unsigned int docId, unsigned int version) {
+    return "/docs/" + std::to_string(docId) + "/v" + std::to_string(version);
+}
+
+bool hasPrefix(const std::string& s, const std::string& prefix) {
+    return s.compare(0, prefix.size(), prefix) == 0;
+}
+
+void testGuardKeepsReplacedPath() {
+    DocPathTable table;
+    table.set(7, pathOf(7, 0));
+
+    const std::string* held = nullptr;
+    {
+        DocPathTable::ReadGuard guard(table);
+        held = guard.get(7);
+        CHECK(held != nullptr && *held == pathOf(7, 0));
+
+        // Поки guard живий, заміни не звільняють рядок, який він бачив.
+        for (unsigned int version = 1; version <= 100; ++version) {
+            table.set(7, pathOf(7, version));
+        }
+        CHECK(*held == pathOf(7, 0));
+        CHECK(table.retiredCount() > 0);
+        CHECK(*guard.get(7) == pathOf(7, 100));
+    }
+
+    // Без читачів наступний запис звільняє все накопичене.
+    table.set(7, pathOf(7, 101));
+    CHECK(table.retiredCount() == 0);
+    CHECK(table.remove(7));
+    CHECK(!table.remove(7));
+    CHECK(table.retiredCount() == 0);
+
+    DocPathTable::ReadGuard guard(table);
+    CHECK(guard.get(7) == nullptr);
+    CHECK(guard.get(1u << 30) == nullptr);
+}
+
+// Читачі безперервно тримають guard-и, що перекриваються, поки писач
+// замінює, видаляє й додає шляхи (зокрема в нових шматках каталогу).
+void testConcurrentReadersAndWriter() {
+    constexpr unsigned int kDocs   = 3 * DocPathTable::kChunkSize;
+    constexpr unsigned int kRounds  = 30;
+    DocPathTable table;
+    for (unsigned int docId = 0; docId < kDocs; docId += 2) {
+        table.set(docId, pathOf(docId, 0));
+    }
+
+    std::atomic<bool> done(false);
+    std::atomic<unsigned int> bad(0);
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&, r]() {
+            std::mt19937 rng(static_cast<unsigned int>(r));
+            std::uniform_int_distribution<unsigned int> pick(0, kDocs - 1);
+            while (!done.load()) {
+                DocPathTable::ReadGuard guard(table);
+                std::vector<std::pair<unsigned int, const std::string*>> seen;
+                for (int i = 0; i < 64; ++i) {
+                    unsigned int docId = pick(rng);
+                    const std::string* path = guard.get(docId);
+                    if (path != nullptr) {
+                        seen.emplace_back(docId, path);
+                    }
+                }
+                std::this_thread::yield();
+                // Після паузи всі отримані вказівники все ще вказують на свій рядок.
+                for (const auto& entry : seen) {
+                    if (!hasPrefix(*entry.second, "/docs/" + std::to_string(entry.first) + "/v")) {
+                        bad.fetch_add(1);
+                    }
+                }
+            }
+        });
+    }
+
+    for (unsigned int round = 1; round <= kRounds; ++round) {
+        for (unsigned int docId = round % 2; docId < kDocs; docId += 2) {
+            table.set(docId, pathOf(docId, round));
+        }
+        for (unsigned int docId = (round + 1) % 2; docId < kDocs; docId += 7) {
+            table.remove(docId);
+        }
+    }
+    table.set(kDocs * 4, pathOf(kDocs * 4, 0));
+
+    done.store(true);
+    for (std::thread& t : readers) {
+        t.join();
+    }
+    CHECK(bad.load() == 0);
+
+    table.set(0, pathOf(0, kRounds + 1));
+    CHECK(table.retiredCount() == 0);
+
+    table.clear();
+    DocPathTable::ReadGuard guard(table);
+    CHECK(guard.get(0) == nullptr && guard.get(kDocs * 4) == nullptr);
+}
+
+struct CollectSink {
+    std::size_t              announced = 0;
+    std::vector<std::string> paths;
+
+    void begin(std::size_t count) {
+        announced = count;
+    }
+
+    void path(const std::string& p) {
+        paths.push_back(p);
+    }
+};
+
+std::vector<std::string> window(const IndexManager& index,
+                                const std::vector<unsigned int>& docIds,
+                                std::size_t offset, std::size_t limit,
+                                ResultOrder order = ResultOrder::ByPath) {
+    ResultWindow w;
+    w.offset = offset;
+    w.limit  = limit;
+    w.order  = order;
+    CollectSink sink;
+    std::size_t count = index.materialize(docIds, w, sink);
+    CHECK(count == sink.paths.size() && sink.announced == count);
+    return sink.paths;
+}
+
+void testWindow(const std::filesystem::path& dir) {
+    // Порядок додавання (docId) відрізняється від порядку шляхів.
+    const std::vector<std::string> names = {"e.txt", "a.txt", "d.txt", "b.txt", "c.txt"};
+    IndexManager index;
+    std::vector<std::string> added;
+    for (const std::string& name : names) {
+        std::filesystem::path path = dir / name;
+        std::ofstream(path) << "common\n";
+        CHECK(index.addFile(path.string()));
+        added.push_back(path.string());
+    }
+
+    std::vector<unsigned int> docIds;
+    CHECK(index.findSingleWord("common", docIds));
+    CHECK(docIds.size() == names.size());
+    const std::size_t kAll = std::numeric_limits<std::size_t>::max();
+
+    std::vector<std::string> byPath = window(index, docIds, 0, kAll);
+    CHECK(byPath.size() == 5);
+    CHECK(std::is_sorted(byPath.begin(), byPath.end()));
+    CHECK(window(index, docIds, 0, kAll, ResultOrder::ByDocId) == added);
+
+    // Сторінки: часткове сортування дає той самий зріз, що й повне.
+    CHECK(window(index, docIds, 1, 2) == std::vector<std::string>(byPath.begin() + 1, byPath.begin() + 3));
+    CHECK(window(index, docIds, 3, 10) == std::vector<std::string>(byPath.begin() + 3, byPath.end()));
+    CHECK(window(index, docIds, 1, 2, ResultOrder::ByDocId)
+          == std::vector<std::string>(added.begin() + 1, added.begin() + 3));
+
+    // offset >= size, limit = 0 і переповнення offset + limit.
+    CHECK(window(index, docIds, 5, kAll).empty());
+    CHECK(window(index, docIds, kAll, kAll).empty());
+    CHECK(window(index, docIds, 0, 0).empty());
+    CHECK(window(index, docIds, 4, kAll) == std::vector<std::string>(1, byPath.back()));
+    CHECK(window(index, docIds, kAll - 1, 2).empty());
+
+    // docId без шляху (видалений документ) пропускається ще до вікна.
+    CHECK(index.removeFile(added.front()));
+    CHECK(window(index, docIds, 0, kAll, ResultOrder::ByDocId)
+          == std::vector<std::string>(added.begin() + 1, added.end()));
+    CHECK(window(index, {docIds.front(), 1u << 30}, 0, kAll).empty());
+
+    std::vector<std::string> out;
+    ResultWindow page;
+    page.offset = 10;
+    CHECK(!index.searchSingleWord("common", out, page) && out.empty());
+}
+
+} // namespace
+
+int main() {
+    testGuardKeepsReplacedPath();
+    testConcurrentReadersAndWriter();
+
+    std::filesystem::path dir = std::filesystem::temp_directory_path()
+                              / ("cw_materialize_test_" + std::to_string(std::random_device()()));
+    std::filesystem::create_directories(dir);
+    testWindow(dir);
+    std::filesystem::remove_all(dir);
+    return test::result("materialize_test");
+}
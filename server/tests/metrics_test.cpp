@@ -0,0 +1,174 @@
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+#include "metrics.h"
+#include "test_check.h"
+
+// Підсистема метрик: кошики й перцентилі гістограми, шардовані лічильники,
+// текст Prometheus і короткий звіт. Із CW_DISABLE_METRICS запис - no-op, тож
+// значення перевіряються лише при ввімкнених метриках.
+
+namespace {
+
+using metrics::LatencyHistogram;
+
+bool contains(const std::string& text, const std::string& line) {
+    return text.find(line + "\n") != std::string::npos;
+}
+
+std::size_t occurrences(const std::string& text, const std::string& what) {
+    std::size_t count = 0;
+    for (std::size_t pos = text.find(what); pos != std::string::npos; pos = text.find(what, pos + 1)) {
+        ++count;
+    }
+    return count;
+}
+
+void testBuckets() {
+    // Малі значення - точні кошики.
+    for (std::uint64_t v = 0; v < LatencyHistogram::kSubBuckets; ++v) {
+        CHECK(LatencyHistogram::bucketIndex(v) == v);
+        CHECK(LatencyHistogram::bucketUpperBound(v) == v);
+    }
+
+    // Далі межа кошика не менша за значення і не більша на 1/16.
+    bool bounded   = true;
+    bool monotonic = true;
+    std::size_t previous = 0;
+    for (std::uint64_t v = LatencyHistogram::kSubBuckets; v < (1ull << 40); v += v / 7 + 1) {
+        std::size_t index = LatencyHistogram::bucketIndex(v);
+        std::uint64_t upper = LatencyHistogram::bucketUpperBound(index);
+        bounded   = bounded && upper >= v && upper - v <= v / LatencyHistogram::kSubBuckets;
+        monotonic = monotonic && index >= previous;
+        previous  = index;
+    }
+    CHECK(bounded);
+    CHECK(monotonic);
+    CHECK(LatencyHistogram::bucketIndex(~0ull) == LatencyHistogram::kBucketCount - 1);
+}
+
+void testPercentiles() {
+    LatencyHistogram histogram;
+    CHECK(histogram.snapshot().percentile(0.5) == 0);
+
+    // 1..1000 мкс, рівномірно.
+    for (std::uint64_t i = 1; i <= 1000; ++i) {
+        histogram.record(i * 1000);
+    }
+    LatencyHistogram::Snapshot snap = histogram.snapshot();
+#ifndef CW_DISABLE_METRICS
+    CHECK(snap.count == 1000);
+    CHECK(snap.sum == 500500ull * 1000);
+    CHECK(snap.max == 1000000);
+    std::uint64_t p50 = snap.percentile(0.50);
+    std::uint64_t p99 = snap.percentile(0.99);
+    CHECK(p50 >= 500000 && p50 <= 500000 + 500000 / 16);
+    CHECK(p99 >= 990000 && p99 <= 1000000);
+    CHECK(snap.percentile(1.0) == snap.max);
+    CHECK(snap.percentile(0.0) >= 1000 && snap.percentile(0.0) <= 1000 + 1000 / 16);
+#else
+    CHECK(snap.count == 0 && snap.percentile(0.99) == 0);
+#endif
+}
+
+void testCounters() {
+    metrics::Counter counter;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&counter]() {
+            for (int i = 0; i < 10000; ++i) {
+                counter.add();
+            }
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    metrics::Counter mirror;
+    mirror.raiseTo(10);
+    mirror.raiseTo(5);
+
+    metrics::Gauge gauge;
+    gauge.set(5);
+    gauge.add(-7);
+    CHECK(gauge.value() == -2);
+#ifndef CW_DISABLE_METRICS
+    CHECK(counter.value() == 40000);
+    CHECK(mirror.value() == 10);
+#else
+    CHECK(counter.value() == 0 && mirror.value() == 0);
+#endif
+}
+
+void testPrometheusText() {
+    metrics::Registry r;
+    metrics::Counter& ok     = r.counter("cw_test_requests_total", "Requests", "status=\"ok\"");
+    metrics::Counter& failed = r.counter("cw_test_requests_total", "Requests", "status=\"error\"");
+    CHECK(&r.counter("cw_test_requests_total", "Requests", "status=\"ok\"") == &ok);
+    r.gauge("cw_test_connections", "Open connections").set(3);
+    LatencyHistogram& latency = r.histogram("cw_test_duration_seconds", "Latency", "op=\"get\"");
+    ok.add(3);
+    failed.add();
+    latency.record(2000);               // 2 мкс
+    latency.record(2000000000ull);      // 2 с
+
+    std::string text = r.renderPrometheus();
+    // HELP і TYPE - раз на ім'я, а не на кожен набір міток.
+    CHECK(occurrences(text, "# HELP cw_test_requests_total Requests\n") == 1);
+    CHECK(occurrences(text, "# TYPE cw_test_requests_total counter\n") == 1);
+    CHECK(contains(text, "# TYPE cw_test_connections gauge"));
+    CHECK(contains(text, "# TYPE cw_test_duration_seconds histogram"));
+    CHECK(contains(text, "cw_test_connections 3"));
+    CHECK(occurrences(text, "cw_test_duration_seconds_bucket{op=\"get\",le=") == 15);
+
+    std::vector<std::string> summary = r.renderSummary();
+#ifndef CW_DISABLE_METRICS
+    CHECK(contains(text, "cw_test_requests_total{status=\"ok\"} 3"));
+    CHECK(contains(text, "cw_test_requests_total{status=\"error\"} 1"));
+    // Кумулятивні кошики в секундах: 2 мкс уже в le=5e-06, 2 с - лише в +Inf.
+    CHECK(contains(text, "cw_test_duration_seconds_bucket{op=\"get\",le=\"1e-06\"} 0"));
+    CHECK(contains(text, "cw_test_duration_seconds_bucket{op=\"get\",le=\"5e-06\"} 1"));
+    CHECK(contains(text, "cw_test_duration_seconds_bucket{op=\"get\",le=\"1\"} 1"));
+    CHECK(contains(text, "cw_test_duration_seconds_bucket{op=\"get\",le=\"+Inf\"} 2"));
+    CHECK(contains(text, "cw_test_duration_seconds_count{op=\"get\"} 2"));
+    CHECK(summary.size() == 4);
+#else
+    // Порожні гістограми до звіту не потрапляють.
+    CHECK(summary.size() == 3);
+#endif
+}
+
+void testLockMetrics() {
+    metrics::LockMetrics& lm = metrics::lockMetricsFor("metrics_test");
+    CHECK(&metrics::lockMetricsFor("metrics_test") == &lm);
+
+    std::shared_mutex m;
+    {
+        auto first  = metrics::lockShared(m, lm);
+        auto second = metrics::lockShared(m, lm);
+    }
+    {
+        auto exclusive = metrics::lockExclusive(m, lm);
+    }
+#ifndef CW_DISABLE_METRICS
+    CHECK(lm.sharedAcquired.value() == 2);
+    CHECK(lm.exclusiveAcquired.value() == 1);
+    CHECK(lm.contended.value() == 0);
+#endif
+    CHECK(metrics::registry().renderPrometheus().find("structure=\"metrics_test\"") != std::string::npos);
+}
+
+} // namespace
+
+int main() {
+    testBuckets();
+    testPercentiles();
+    testCounters();
+    testPrometheusText();
+    testLockMetrics();
+    return test::result("metrics_test");
+}
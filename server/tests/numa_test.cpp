@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <atomic>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "numa_topology.h"
+#include "node_replicas.h"
+#include "thread_pool.h"
+#include "test_check.h"
+
+// NUMA без NUMA-машини: розбір cpulist, штучні вузли emulated(n),
+// розкладка воркерів пулу по вузлах і свіжість копій NodeReplicas.
+
+namespace {
+
+typedef std::vector<int> Cpus;
+
+void testParseCpuList() {
+    CHECK(NumaTopology::parseCpuList("0-3,8,10-11") == (Cpus{0, 1, 2, 3, 8, 10, 11}));
+    CHECK(NumaTopology::parseCpuList("0\n") == (Cpus{0}));
+    CHECK(NumaTopology::parseCpuList("2,5-7\n") == (Cpus{2, 5, 6, 7}));
+    CHECK(NumaTopology::parseCpuList("").empty());
+    // Зламані елементи й порожні діапазони пропускаються.
+    CHECK(NumaTopology::parseCpuList("x,1,a-b").size() == 1);
+    CHECK(NumaTopology::parseCpuList("3-1").empty());
+}
+
+void testEmulated() {
+    const NumaTopology& system = NumaTopology::system();
+    CHECK(system.nodeCount() >= 1);
+    CHECK(!system.node(0).cpus.empty());
+
+    NumaTopology single = NumaTopology::emulated(1);
+    CHECK(single.nodeCount() == 1 && !single.isMultiNode());
+    CHECK(single.currentNode() == 0);
+
+    // Кожен штучний вузол має CPU, і разом вони покривають усі дозволені.
+    NumaTopology four = NumaTopology::emulated(4);
+    CHECK(four.nodeCount() == 4 && four.isMultiNode());
+    std::set<int> covered;
+    for (std::size_t i = 0; i < four.nodeCount(); ++i) {
+        CHECK(four.node(i).id == static_cast<int>(i));
+        CHECK(!four.node(i).cpus.empty());
+        covered.insert(four.node(i).cpus.begin(), four.node(i).cpus.end());
+    }
+    CHECK(covered == std::set<int>(single.node(0).cpus.begin(), single.node(0).cpus.end()));
+    CHECK(four.nodeOfCpu(-1) == 0);
+
+    NumaTopology::setThreadNodeHint(3);
+    CHECK(four.currentNode() == 3);
+    NumaTopology::setThreadNodeHint(-1);
+    CHECK(four.currentNode() < four.nodeCount());
+}
+
+void testPoolPlacement() {
+    NumaTopology two = NumaTopology::emulated(2);
+    {
+        ThreadPool pool(4, WorkerPinning::Node, two);
+        std::vector<ThreadPool::WorkerStats> stats = pool.getWorkerStats();
+        for (std::size_t i = 0; i < stats.size(); ++i) {
+            CHECK(stats[i].node == static_cast<int>(i % 2));
+            CHECK(stats[i].cpu == -1);
+        }
+        CHECK(pool.submit([]() { return 1; }).get() == 1);
+    }
+    {
+        ThreadPool pool(4, WorkerPinning::Cpu, two);
+        for (const ThreadPool::WorkerStats& s : pool.getWorkerStats()) {
+            const Cpus& cpus = two.node(static_cast<std::size_t>(s.node)).cpus;
+            CHECK(std::find(cpus.begin(), cpus.end(), s.cpu) != cpus.end());
+        }
+        // Воркер бачить вузол, за яким його закріплено.
+        const std::size_t kUnseen = static_cast<std::size_t>(-1);
+        std::vector<std::size_t> nodes(pool.size(), kUnseen);
+        pool.parallelFor(0, 64, [&](std::size_t, std::size_t) {
+            int index = pool.currentWorkerIndex();
+            if (index >= 0) {
+                nodes[static_cast<std::size_t>(index)] = two.currentNode();
+            }
+        }, 1);
+        std::vector<ThreadPool::WorkerStats> stats = pool.getWorkerStats();
+        for (std::size_t i = 0; i < stats.size(); ++i) {
+            CHECK(nodes[i] == kUnseen || nodes[i] == static_cast<std::size_t>(stats[i].node));
+        }
+    }
+}
+
+void testReplicaStaleness() {
+    std::atomic<int> primary(1);
+    std::atomic<int> builds(0);
+    NodeReplicas<int> replicas(NumaTopology::emulated(2), [&](int& copy) {
+        copy = primary.load();
+        builds.fetch_add(1);
+    }, 10);
+    CHECK(replicas.enabled());
+    CHECK(replicas.waitUntilFresh(10000));
+
+    NumaTopology::setThreadNodeHint(1);
+    std::shared_ptr<const int> local = replicas.local();
+    CHECK(local != nullptr && *local == 1);
+
+    {
+        // Поки йде зміна, копія не видається.
+        NodeReplicas<int>::WriteScope write(&replicas);
+        primary.store(2);
+        CHECK(replicas.local() == nullptr);
+    }
+    // Після зміни - теж, доки копію не перебудовано.
+    CHECK(replicas.local() == nullptr);
+    CHECK(*local == 1);     // уже видана копія живе далі
+
+    CHECK(replicas.waitUntilFresh(10000));
+    for (std::size_t node = 0; node < 2; ++node) {
+        NumaTopology::setThreadNodeHint(static_cast<int>(node));
+        local = replicas.local();
+        CHECK(local != nullptr && *local == 2);
+    }
+    CHECK(builds.load() >= 4);
+    NumaTopology::setThreadNodeHint(-1);
+
+    // На одному вузлі копій немає: завжди читається первинна структура.
+    NodeReplicas<int> single(NumaTopology::emulated(1), [](int& copy) { copy = 0; });
+    CHECK(!single.enabled());
+    CHECK(single.local() == nullptr);
+    CHECK(single.waitUntilFresh(0));
+    NodeReplicas<int>::WriteScope noop(nullptr);
+}
+
+} // namespace
+
+int main() {
+    testParseCpuList();
+    testEmulated();
+    testPoolPlacement();
+    testReplicaStaleness();
+    return test::result("numa_test");
+}
@@ -0,0 +1,191 @@
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "posting_list.h"
+#include "posting_ops.h"
+#include "thread_pool.h"
+#include "deadline.h"
+#include "test_check.h"
+
+// Ядра списків документів: контейнери PostingList (масив/бітова мапа) і
+// об'єднання posting_ops порівнюються з std::set на випадкових наборах.
+
+namespace {
+
+typedef std::set<unsigned int> Reference;
+
+PostingList makeList(const Reference& docIds) {
+    PostingList list;
+    for (unsigned int docId : docIds) {
+        list.add(docId);
+    }
+    return list;
+}
+
+std::vector<unsigned int> toVector(const PostingList& list) {
+    std::vector<unsigned int> out;
+    list.toVector(out);
+    return out;
+}
+
+std::vector<unsigned int> toVector(const Reference& docIds) {
+    return std::vector<unsigned int>(docIds.begin(), docIds.end());
+}
+
+// Щільність задає, скільки контейнерів стане бітовими мапами.
+Reference randomSet(std::mt19937& rng, std::size_t count, unsigned int upper) {
+    std::uniform_int_distribution<unsigned int> pick(0, upper - 1);
+    Reference docIds;
+    while (docIds.size() < count) {
+        docIds.insert(pick(rng));
+    }
+    return docIds;
+}
+
+void testAddRemove() {
+    PostingList list;
+    CHECK(list.empty());
+    CHECK(list.add(5));
+    CHECK(!list.add(5));
+    CHECK(list.add(70000));
+    CHECK(list.contains(5) && list.contains(70000) && !list.contains(6));
+    CHECK(list.cardinality() == 2);
+    CHECK(list.maxDocId() == 70000);
+    CHECK(list.remove(5));
+    CHECK(!list.remove(5));
+    CHECK(toVector(list) == std::vector<unsigned int>{70000});
+
+    // Перехід масив -> бітова мапа -> масив в одному контейнері.
+    Reference dense;
+    for (unsigned int docId = 0; docId < 10000; ++docId) {
+        dense.insert(docId * 3);
+    }
+    PostingList big = makeList(dense);
+    CHECK(big.cardinality() == dense.size());
+    CHECK(toVector(big) == toVector(dense));
+    for (unsigned int docId = 0; docId < 10000; docId += 2) {
+        big.remove(docId * 3);
+        dense.erase(docId * 3);
+    }
+    CHECK(toVector(big) == toVector(dense));
+    CHECK(big == makeList(dense));
+}
+
+void testSetOperations() {
+    std::mt19937 rng(7);
+    for (int round = 0; round < 20; ++round) {
+        unsigned int upper = round % 2 == 0 ? 200000 : 20000;
+        Reference a = randomSet(rng, 3000 + round * 100, upper);
+        Reference b = randomSet(rng, 2000 + round * 300, upper);
+        PostingList la = makeList(a);
+        PostingList lb = makeList(b);
+
+        std::vector<unsigned int> expected;
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+        CHECK(toVector(PostingList::intersect(la, lb)) == expected);
+
+        expected.clear();
+        std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+        CHECK(toVector(PostingList::unite(la, lb)) == expected);
+
+        expected.clear();
+        std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+        CHECK(toVector(PostingList::subtract(la, lb)) == expected);
+
+        PostingList inPlace = la;
+        inPlace.subtractWith(lb);
+        CHECK(toVector(inPlace) == expected);
+    }
+}
+
+void testUniteMany() {
+    std::mt19937 rng(11);
+    std::vector<PostingList> lists;
+    Reference all;
+    for (int i = 0; i < 12; ++i) {
+        // Малі списки йдуть через злиття масивів, великі - через бітові мапи.
+        Reference docIds = randomSet(rng, i % 3 == 0 ? 20 : 4000, 150000);
+        all.insert(docIds.begin(), docIds.end());
+        lists.push_back(makeList(docIds));
+    }
+    std::vector<const PostingList*> refs;
+    for (const PostingList& list : lists) {
+        refs.push_back(&list);
+    }
+    CHECK(toVector(PostingList::uniteMany(refs)) == toVector(all));
+
+    std::vector<const PostingList*> small = {&lists[0], &lists[3]};
+    Reference expected;
+    lists[0].forEach([&](unsigned int docId) { expected.insert(docId); });
+    lists[3].forEach([&](unsigned int docId) { expected.insert(docId); });
+    CHECK(toVector(PostingList::uniteMany(small)) == toVector(expected));
+}
+
+void testUnionPostings() {
+    std::mt19937 rng(13);
+    ThreadPool pool(4);
+
+    for (std::size_t listCount : {1u, 2u, 5u, 16u}) {
+        std::vector<PostingList> lists;
+        Reference all;
+        for (std::size_t i = 0; i < listCount; ++i) {
+            // 20000 записів на список - вище порогу паралельного об'єднання.
+            Reference docIds = randomSet(rng, 20000, 1u << 22);
+            all.insert(docIds.begin(), docIds.end());
+            lists.push_back(makeList(docIds));
+        }
+        posting_ops::PostingRefs refs;
+        for (const PostingList& list : lists) {
+            refs.push_back(&list);
+        }
+
+        std::vector<unsigned int> sequential;
+        posting_ops::unionPostings(refs, sequential, nullptr);
+        CHECK(sequential == toVector(all));
+
+        std::vector<unsigned int> parallel;
+        posting_ops::unionPostings(refs, parallel, &pool);
+        CHECK(parallel == toVector(all));
+
+        // Вичерпаний термін: результат порожній в обох шляхах.
+        Deadline expired(Deadline::Clock::now() - std::chrono::milliseconds(1));
+        if (listCount > 1) {
+            posting_ops::unionPostings(refs, sequential, nullptr, &expired);
+            CHECK(sequential.empty());
+            posting_ops::unionPostings(refs, parallel, &pool, &expired);
+            CHECK(parallel.empty());
+        }
+    }
+
+    std::vector<unsigned int> out = {1, 2, 3};
+    posting_ops::unionPostings(posting_ops::PostingRefs(), out, &pool);
+    CHECK(out.empty());
+}
+
+void testParallelSort() {
+    std::mt19937 rng(17);
+    ThreadPool pool(4);
+    std::vector<unsigned int> values(100000);
+    for (unsigned int& value : values) {
+        value = rng();
+    }
+    std::vector<unsigned int> expected = values;
+    std::sort(expected.begin(), expected.end());
+    posting_ops::parallelSort(values, &pool);
+    CHECK(values == expected);
+}
+
+} // namespace
+
+int main() {
+    testAddRemove();
+    testSetOperations();
+    testUniteMany();
+    testUnionPostings();
+    testParallelSort();
+    return test::result("posting_ops_test");
+}
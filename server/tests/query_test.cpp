@@ -0,0 +1,177 @@
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "query_parser.h"
+#include "query_planner.h"
+#include "thread_pool.h"
+#include "deadline.h"
+#include "test_check.h"
+
+// Парсер булевих запитів і планувальник над невеликим словником у пам'яті.
+
+namespace {
+
+// Документи 0..9; терм -> список документів.
+class MapSource {
+public:
+    MapSource() {
+        add("a", {0, 1, 2, 3, 4});
+        add("b", {3, 4, 5, 6});
+        add("c", {4, 6, 8});
+        add("d", {1, 3, 5, 7, 9});
+        add("rare", {8});
+    }
+
+    bool lookupTerm(const std::string& term, unsigned int& outWordId, std::size_t& outCount) const {
+        auto it = ids.find(term);
+        if (it == ids.end()) {
+            return false;
+        }
+        outWordId = it->second;
+        outCount  = lists[it->second].cardinality();
+        return true;
+    }
+
+    void fetchTerm(unsigned int wordId, PostingList& out) const {
+        out = lists[wordId];
+    }
+
+    void fetchAll(PostingList& out) const {
+        out.clear();
+        for (unsigned int docId = 0; docId < 10; ++docId) {
+            out.add(docId);
+        }
+    }
+
+    std::size_t documentCount() const {
+        return 10;
+    }
+
+private:
+    void add(const std::string& term, const std::vector<unsigned int>& docIds) {
+        PostingList list;
+        for (unsigned int docId : docIds) {
+            list.add(docId);
+        }
+        ids[term] = static_cast<unsigned int>(lists.size());
+        lists.push_back(list);
+    }
+
+    std::map<std::string, unsigned int> ids;
+    std::vector<PostingList>            lists;
+};
+
+bool parse(const std::string& text, std::unique_ptr<QueryNode>& root, std::string& error) {
+    QueryParser parser;
+    return parser.parse(text, root, error);
+}
+
+std::vector<unsigned int> run(const std::string& text, ThreadPool* pool = nullptr) {
+    std::unique_ptr<QueryNode> root;
+    std::string error;
+    if (!parse(text, root, error)) {
+        return {9999};
+    }
+    MapSource source;
+    QueryPlanner<MapSource> planner(source, pool);
+    std::unique_ptr<PlanNode> plan = planner.plan(*root);
+    PostingList result;
+    planner.execute(*plan, result);
+    std::vector<unsigned int> out;
+    result.toVector(out);
+    return out;
+}
+
+void testParser() {
+    std::unique_ptr<QueryNode> root;
+    std::string error;
+
+    CHECK(parse("a b OR c", root, error));
+    CHECK(root->kind == QueryNode::Kind::Or);
+    CHECK(root->children.size() == 2);
+    CHECK(root->children[0]->kind == QueryNode::Kind::And);
+
+    CHECK(parse("NOT NOT a", root, error));
+    CHECK(root->kind == QueryNode::Kind::Not);
+    CHECK(root->children.front()->kind == QueryNode::Kind::Not);
+
+    // Оператори - лише великими літерами.
+    CHECK(parse("a and b", root, error));
+    CHECK(root->kind == QueryNode::Kind::And && root->children.size() == 3);
+
+    CHECK(!parse("", root, error) && error == "Empty query");
+    CHECK(!parse("a AND", root, error) && error == "Unexpected end of query");
+    CHECK(!parse("(a OR b", root, error) && error == "Missing ')'");
+    CHECK(!parse("a )", root, error) && error == "Unexpected token ')'");
+    CHECK(!parse("OR a", root, error));
+
+    std::string deep;
+    for (int i = 0; i < 100; ++i) {
+        deep += "(";
+    }
+    CHECK(!parse(deep + "a", root, error) && error == "Query nested too deeply");
+}
+
+void testPlanner() {
+    CHECK(run("a") == (std::vector<unsigned int>{0, 1, 2, 3, 4}));
+    CHECK(run("a AND b") == (std::vector<unsigned int>{3, 4}));
+    CHECK(run("a b c") == (std::vector<unsigned int>{4}));
+    CHECK(run("a OR c") == (std::vector<unsigned int>{0, 1, 2, 3, 4, 6, 8}));
+    CHECK(run("a AND NOT d") == (std::vector<unsigned int>{0, 2, 4}));
+    CHECK(run("NOT a") == (std::vector<unsigned int>{5, 6, 7, 8, 9}));
+    CHECK(run("(a OR b) AND NOT (c OR d)") == (std::vector<unsigned int>{0, 2}));
+    // p OR NOT n = NOT (n AND NOT p)
+    CHECK(run("rare OR NOT a") == (std::vector<unsigned int>{5, 6, 7, 8, 9}));
+    CHECK(run("c OR NOT b") == (std::vector<unsigned int>{0, 1, 2, 4, 6, 7, 8, 9}));
+
+    // Невідомий терм - порожня гілка.
+    CHECK(run("a AND missing").empty());
+    CHECK(run("a OR missing") == run("a"));
+    CHECK(run("NOT missing").size() == 10);
+
+    ThreadPool pool(3);
+    CHECK(run("a OR b OR c OR d", &pool) == run("a OR b OR c OR d"));
+}
+
+void testPlanShape() {
+    std::unique_ptr<QueryNode> root;
+    std::string error;
+    CHECK(parse("a AND rare AND b", root, error));
+
+    MapSource source;
+    QueryPlanner<MapSource> planner(source, nullptr);
+    std::unique_ptr<PlanNode> plan = planner.plan(*root);
+    CHECK(plan->kind == PlanNode::Kind::And);
+    CHECK(plan->include.size() == 3);
+    // Найменший операнд іде першим.
+    CHECK(plan->include.front()->estimate == 1);
+
+    CHECK(parse("a AND missing", root, error));
+    CHECK(planner.plan(*root)->kind == PlanNode::Kind::Empty);
+}
+
+void testDeadline() {
+    std::unique_ptr<QueryNode> root;
+    std::string error;
+    CHECK(parse("a OR b", root, error));
+
+    MapSource source;
+    Deadline expired(Deadline::Clock::now() - std::chrono::milliseconds(1));
+    QueryPlanner<MapSource> planner(source, nullptr, &expired);
+    PostingList result;
+    planner.execute(*planner.plan(*root), result);
+    CHECK(result.empty());
+}
+
+} // namespace
+
+int main() {
+    testParser();
+    testPlanner();
+    testPlanShape();
+    testDeadline();
+    return test::result("query_test");
+}
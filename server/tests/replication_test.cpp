@@ -0,0 +1,208 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "server.h"
+#include "test_check.h"
+
+// Журнал змін (кодування, вікно) і лідер з двома фоловерами на localhost:
+// фоловер A отримує записи журналу, фоловер B - знімок, що заміщує його
+// попередній вміст; відступ фоловера, якого сервер не обслуговує.
+
+namespace {
+
+class StringLines {
+public:
+    explicit StringLines(const std::string& text)
+        : text(text)
+        , pos(0)
+    {}
+
+    bool readLine(std::string& outLine) {
+        std::size_t eol = text.find('\n', pos);
+        if (eol == std::string::npos) {
+            return false;
+        }
+        outLine.assign(text, pos, eol - pos);
+        pos = eol + 1;
+        return true;
+    }
+
+private:
+    std::string text;
+    std::size_t pos;
+};
+
+bool decode(const std::string& record, Mutation& outMutation, std::uint64_t& outSeq) {
+    StringLines lines(record);
+    std::string header;
+    std::string error;
+    return lines.readLine(header) && MutationLog::decode(header, lines, outMutation, outSeq, error);
+}
+
+void testEncoding() {
+    Mutation upsert;
+    upsert.kind    = Mutation::Kind::Upsert;
+    upsert.docId   = 42;
+    upsert.docPath = "/tmp/a b.txt";
+    upsert.words   = {{1, "київ"}, {7, "foo"}};
+
+    Mutation decoded;
+    std::uint64_t seq = 0;
+    CHECK(decode(MutationLog::encode(upsert, 5), decoded, seq));
+    CHECK(seq == 5);
+    CHECK(decoded.kind == Mutation::Kind::Upsert);
+    CHECK(decoded.docId == 42 && decoded.docPath == upsert.docPath);
+    CHECK(decoded.words == upsert.words);
+
+    Mutation remove;
+    remove.kind    = Mutation::Kind::Remove;
+    remove.docId   = 3;
+    remove.docPath = "/x";
+    CHECK(decode(MutationLog::encode(remove, 6), decoded, seq));
+    CHECK(decoded.kind == Mutation::Kind::Remove && decoded.docId == 3 && seq == 6);
+
+    Mutation clear;
+    clear.kind = Mutation::Kind::Clear;
+    CHECK(decode(MutationLog::encode(clear, 7), decoded, seq));
+    CHECK(decoded.kind == Mutation::Kind::Clear && seq == 7);
+
+    // Обірваний запис і невідомий заголовок.
+    std::string truncated = MutationLog::encode(upsert, 8);
+    truncated.resize(truncated.find('\n') + 1);
+    CHECK(!decode(truncated, decoded, seq));
+    CHECK(!decode("BOGUS 1\n", decoded, seq));
+}
+
+void testLogWindow() {
+    MutationLog log(4);
+    Mutation clear;
+    clear.kind = Mutation::Kind::Clear;
+    for (int i = 0; i < 6; ++i) {
+        log.append(clear);
+    }
+    CHECK(log.lastSeq() == 6);
+
+    std::vector<std::string> records;
+    CHECK(log.read(3, records, 10, 0) == MutationLog::ReadStatus::Ok);
+    CHECK(records.size() == 4);
+    CHECK(log.read(5, records, 1, 0) == MutationLog::ReadStatus::Ok && records.size() == 1);
+    CHECK(log.read(2, records, 10, 0) == MutationLog::ReadStatus::Truncated);
+    CHECK(log.read(7, records, 10, 0) == MutationLog::ReadStatus::Ok && records.empty());
+
+    log.stop();
+    CHECK(log.read(7, records, 10, 1000) == MutationLog::ReadStatus::Stopped);
+}
+
+std::vector<std::string> search(const IndexManager& index, const std::string& word) {
+    std::vector<std::string> paths;
+    index.searchSingleWord(word, paths);
+    return paths;
+}
+
+void testLeaderFollowers(const std::filesystem::path& dir) {
+    std::vector<std::string> paths;
+    for (int i = 0; i < 20; ++i) {
+        std::filesystem::path path = dir / ("doc" + std::to_string(i) + ".txt");
+        std::ofstream(path) << "common word" << i << (i % 2 == 0 ? " even" : " odd") << "\n";
+        paths.push_back(path.string());
+    }
+    std::filesystem::path stale = dir / "stale.txt";
+    std::ofstream(stale) << "stale\n";
+
+    CHECK(Server::initSockets());
+    MutationLog log;
+    Server leaderServer(2);
+    IndexManager& primary = leaderServer.getIndexManager();
+    primary.setMutationLog(&log);
+    replication::Leader leader(primary, log);
+    leaderServer.setReplicationLeader(&leader);
+    CHECK(leaderServer.initServer("127.0.0.1", 0));
+    std::thread acceptThread([&leaderServer]() { leaderServer.acceptLoop(); });
+    int port = leaderServer.boundPort();
+
+    IndexManager replicaA;
+    replication::Follower followerA(replicaA, "127.0.0.1", port);
+    followerA.start();
+
+    for (const std::string& path : paths) {
+        CHECK(primary.addFile(path));
+    }
+    CHECK(followerA.waitForSeq(log.lastSeq(), 10000));
+    CHECK(replicaA.documentCount() == paths.size());
+    CHECK(search(replicaA, "even") == search(primary, "even"));
+
+    for (std::size_t i = 0; i < paths.size(); i += 3) {
+        CHECK(primary.removeFile(paths[i]));
+    }
+
+    // Локальний вміст репліки B заміщується знімком лідера.
+    IndexManager replicaB;
+    CHECK(replicaB.addFile(stale.string()));
+    replication::Follower followerB(replicaB, "127.0.0.1", port);
+    followerB.start();
+
+    std::uint64_t target = log.lastSeq();
+    CHECK(followerA.waitForSeq(target, 10000));
+    CHECK(followerB.waitForSeq(target, 10000));
+    for (const char* word : {"common", "even", "odd", "word5"}) {
+        CHECK(search(replicaA, word) == search(primary, word));
+        CHECK(search(replicaB, word) == search(primary, word));
+    }
+    CHECK(search(replicaB, "stale").empty());
+    CHECK(replicaB.documentCount() == primary.documentCount());
+
+    // Перепідключення: лідер має приєднати потік відключеного фоловера.
+    followerA.stop();
+    IndexManager replicaC;
+    replication::Follower followerC(replicaC, "127.0.0.1", port);
+    followerC.start();
+    CHECK(followerC.waitForSeq(target, 10000));
+    CHECK(replicaC.documentCount() == primary.documentCount());
+
+    followerB.stop();
+    followerC.stop();
+    leader.stop();
+    leaderServer.stop();
+    acceptThread.join();
+}
+
+// Сервер без лідера реплікації відповідає ERROR на REPLICATE: фоловер має
+// відступати (100, 200, 400, 800 мс), а не перепідключатися 10 разів на секунду.
+void testBackoffWithoutLeader() {
+    CHECK(Server::initSockets());
+    Server plain(1);
+    CHECK(plain.initServer("127.0.0.1", 0));
+    std::thread acceptThread([&plain]() { plain.acceptLoop(); });
+
+    IndexManager replica;
+    replication::Follower follower(replica, "127.0.0.1", plain.boundPort());
+    follower.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+    follower.stop();
+
+    CHECK(follower.connectCount() >= 2);
+    CHECK(follower.connectCount() <= 6);
+    CHECK(follower.appliedSeq() == 0);
+
+    plain.stop();
+    acceptThread.join();
+}
+
+} // namespace
+
+int main() {
+    testEncoding();
+    testLogWindow();
+
+    std::filesystem::path dir = std::filesystem::temp_directory_path()
+                              / ("cw_replication_test_" + std::to_string(std::random_device()()));
+    std::filesystem::create_directories(dir);
+    testLeaderFollowers(dir);
+    std::filesystem::remove_all(dir);
+    testBackoffWithoutLeader();
+    return test::result("replication_test");
+}
@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <random>
+#include <set>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "segmented_index.h"
+#include "thread_pool.h"
+#include "test_check.h"
+
+// Сегментований індекс з дрібними сегментами: додавання, видалення та
+// переіндексація документів поряд із фоновими злиттями порівнюються з
+// еталонною мапою слово -> документи.
+
+namespace {
+
+constexpr unsigned int kWords = 40;
+constexpr unsigned int kDocs  = 600;
+
+class Model {
+public:
+    void add(unsigned int docId, const std::unordered_set<unsigned int>& wordIds) {
+        docs[docId] = wordIds;
+    }
+
+    void remove(unsigned int docId) {
+        docs.erase(docId);
+    }
+
+    bool has(unsigned int docId) const {
+        return docs.count(docId) != 0;
+    }
+
+    const std::unordered_set<unsigned int>& wordsOf(unsigned int docId) const {
+        return docs.at(docId);
+    }
+
+    std::vector<unsigned int> documents(const std::vector<unsigned int>& wordIds) const {
+        std::vector<unsigned int> out;
+        for (const auto& entry : docs) {
+            bool all = std::all_of(wordIds.begin(), wordIds.end(), [&](unsigned int wordId) {
+                return entry.second.count(wordId) != 0;
+            });
+            if (all) {
+                out.push_back(entry.first);
+            }
+        }
+        return out;
+    }
+
+private:
+    std::map<unsigned int, std::unordered_set<unsigned int>> docs;
+};
+
+std::unordered_set<unsigned int> randomWords(std::mt19937& rng) {
+    std::uniform_int_distribution<unsigned int> count(1, 8);
+    std::uniform_int_distribution<unsigned int> word(0, kWords - 1);
+    std::unordered_set<unsigned int> wordIds;
+    for (unsigned int i = count(rng); i > 0; --i) {
+        wordIds.insert(word(rng));
+    }
+    return wordIds;
+}
+
+std::vector<unsigned int> toVector(const PostingList& list) {
+    std::vector<unsigned int> out;
+    list.toVector(out);
+    return out;
+}
+
+void compare(const SegmentedIndex& index, const Model& model) {
+    for (unsigned int wordId = 0; wordId < kWords; ++wordId) {
+        std::vector<unsigned int> expected = model.documents({wordId});
+        PostingList docIds;
+        CHECK(index.getDocuments(wordId, docIds) == !expected.empty());
+        CHECK(toVector(docIds) == expected);
+        // Оцінка не віднімає видалених, тож не менша за точну кількість.
+        CHECK(index.getCardinality(wordId) >= expected.size());
+
+        std::vector<unsigned int> pair = {wordId, (wordId * 7 + 3) % kWords};
+        PostingList both;
+        index.intersectDocuments(pair, both);
+        CHECK(toVector(both) == model.documents(pair));
+    }
+}
+
+void run(ThreadPool* pool) {
+    std::mt19937 rng(pool == nullptr ? 3 : 5);
+    SegmentedIndex index;
+    index.setMergePool(pool);
+    index.setMergePolicy(64, 2);
+    Model model;
+
+    std::uniform_int_distribution<unsigned int> pickDoc(0, kDocs - 1);
+    std::uniform_int_distribution<int>          pickOp(0, 9);
+    for (int step = 0; step < 4000; ++step) {
+        unsigned int docId = pickDoc(rng);
+        int op = pickOp(rng);
+        if (!model.has(docId)) {
+            std::unordered_set<unsigned int> wordIds = randomWords(rng);
+            index.addDocument(docId, wordIds);
+            model.add(docId, wordIds);
+        } else if (op < 4) {
+            index.removeDocument(docId, model.wordsOf(docId));
+            model.remove(docId);
+        } else if (op < 7) {
+            // Переіндексація: той самий docId з новим набором слів.
+            std::unordered_set<unsigned int> wordIds = randomWords(rng);
+            index.removeDocument(docId, model.wordsOf(docId));
+            index.addDocument(docId, wordIds);
+            model.add(docId, wordIds);
+        }
+        if (step % 500 == 0) {
+            compare(index, model);
+        }
+    }
+
+    index.waitForMerges();
+    compare(index, model);
+    // Ярусні злиття тримають кількість сегментів логарифмічною.
+    CHECK(index.segmentCount() > 0);
+    CHECK(index.segmentCount() < 40);
+
+    SegmentedIndex copy;
+    copy.copyFrom(index);
+    compare(copy, model);
+
+    index.clear();
+    CHECK(index.segmentCount() == 0);
+    PostingList docIds;
+    CHECK(!index.getDocuments(0, docIds));
+}
+
+// Сегмент будується поза блокуванням: читачі, що йдуть поряд зі скиданнями,
+// не мають втрачати вже додані документи, поки записи заморожені.
+void testReadersDuringFlush(ThreadPool& pool) {
+    constexpr unsigned int kAdded = 3000;
+    SegmentedIndex index;
+    index.setMergePool(&pool);
+    index.setMergePolicy(32, 2);
+
+    std::atomic<unsigned int> added(0);
+    std::atomic<unsigned int> lost(0);
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 2; ++r) {
+        readers.emplace_back([&]() {
+            while (added.load() < kAdded) {
+                unsigned int before = added.load();
+                PostingList docIds;
+                index.getDocuments(0, docIds);
+                PostingList both;
+                index.intersectDocuments({0, 1}, both);
+                if (docIds.cardinality() < before || both.cardinality() < before) {
+                    lost.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (unsigned int docId = 0; docId < kAdded; ++docId) {
+        index.addDocument(docId, {0, 1, 2 + docId % kWords});
+        added.store(docId + 1);
+    }
+    for (std::thread& t : readers) {
+        t.join();
+    }
+    index.waitForMerges();
+    CHECK(lost.load() == 0);
+    CHECK(index.getCardinality(0) == kAdded);
+    CHECK(index.segmentCount() > 0);
+}
+
+} // namespace
+
+int main() {
+    run(nullptr);
+    ThreadPool pool(4);
+    run(&pool);
+    testReadersDuringFlush(pool);
+    return test::result("segmented_index_test");
+}
@@ -0,0 +1,37 @@
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+
+#include <iostream>
+#include <string>
+
+// Мінімальні перевірки для модульних тестів без зовнішніх бібліотек:
+// CHECK лише рахує провали й друкує місце, а main повертає test::result(),
+// тож ctest бачить ненульовий код виходу.
+namespace test {
+
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+inline void check(bool ok, const char* expression, const char* file, int line) {
+    if (!ok) {
+        ++failures();
+        std::cerr << file << ":" << line << ": CHECK failed: " << expression << "\n";
+    }
+}
+
+inline int result(const std::string& name) {
+    if (failures() != 0) {
+        std::cerr << name << ": " << failures() << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << name << ": OK\n";
+    return 0;
+}
+
+} // namespace test
+
+#define CHECK(expression) test::check(static_cast<bool>(expression), #expression, __FILE__, __LINE__)
+
+#endif
@@ -0,0 +1,211 @@
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "work_stealing_deque.h"
+#include "thread_pool.h"
+#include "test_check.h"
+
+// Дек Chase-Lev (власник проти крадіїв) і пул потоків: submit, parallelFor,
+// shutdown та статистика воркерів.
+
+namespace {
+
+constexpr unsigned int kItems = 200000;
+
+// Власник кладе й забирає з дна, троє крадіїв тягнуть з верху; малий
+// початковий буфер змушує дек рости під час крадіжок. Кожен елемент має
+// бути взятий рівно один раз.
+void testDequeOwnerVsThieves() {
+    WorkStealingDeque<unsigned int> deque(4);
+    std::vector<std::atomic<int>> taken(kItems);
+    std::atomic<bool> ownerDone(false);
+
+    std::vector<std::thread> thieves;
+    for (int i = 0; i < 3; ++i) {
+        thieves.emplace_back([&]() {
+            unsigned int value = 0;
+            for (;;) {
+                if (deque.steal(value)) {
+                    taken[value].fetch_add(1);
+                } else if (ownerDone.load() && deque.empty()) {
+                    return;
+                }
+            }
+        });
+    }
+
+    unsigned int value = 0;
+    for (unsigned int i = 0; i < kItems; ++i) {
+        deque.push(i);
+        if (i % 3 == 0 && deque.pop(value)) {
+            taken[value].fetch_add(1);
+        }
+    }
+    while (deque.pop(value)) {
+        taken[value].fetch_add(1);
+    }
+    ownerDone.store(true);
+    for (std::thread& t : thieves) {
+        t.join();
+    }
+
+    bool exactlyOnce = true;
+    for (const std::atomic<int>& count : taken) {
+        exactlyOnce = exactlyOnce && count.load() == 1;
+    }
+    CHECK(exactlyOnce);
+    CHECK(deque.empty());
+}
+
+// Задачі, що породжують задачі: зовнішні йдуть у спільну чергу, дочірні - у
+// дек воркера і звідти забираються власником або крадуться. Кожна
+// виконується рівно раз. shutdown() - лише після останньої: post() після
+// зупинки виконує задачу в потоці виклику, повз дек.
+void testNestedTasks() {
+    ThreadPool pool(4);
+    std::vector<std::atomic<int>> runs(64 * 64);
+    std::atomic<unsigned int> done(0);
+    for (unsigned int i = 0; i < 64; ++i) {
+        pool.post([&pool, &runs, &done, i]() {
+            for (unsigned int j = 0; j < 64; ++j) {
+                pool.post([&runs, &done, i, j]() {
+                    runs[i * 64 + j].fetch_add(1);
+                    done.fetch_add(1);
+                });
+            }
+        });
+    }
+    while (done.load() < runs.size()) {
+        std::this_thread::yield();
+    }
+    pool.shutdown();
+
+    bool exactlyOnce = true;
+    for (const std::atomic<int>& count : runs) {
+        exactlyOnce = exactlyOnce && count.load() == 1;
+    }
+    CHECK(exactlyOnce);
+
+    std::uint64_t executed    = 0;
+    std::uint64_t localPushes = 0;
+    std::uint64_t fromShared  = 0;
+    for (const ThreadPool::WorkerStats& stats : pool.getWorkerStats()) {
+        executed    += stats.executed;
+        localPushes += stats.localPushes;
+        fromShared  += stats.fromShared;
+        CHECK(stats.node == -1 && stats.cpu == -1);
+    }
+    CHECK(executed == 64 + 64 * 64);
+    CHECK(localPushes == 64 * 64);
+    CHECK(fromShared == 64);
+}
+
+void testSubmit() {
+    ThreadPool pool(2);
+    std::future<int> sum = pool.submit([](int a, int b) { return a + b; }, 2, 3);
+    CHECK(sum.get() == 5);
+
+    std::future<int> failing = pool.submit([]() -> int { throw std::runtime_error("boom"); });
+    bool thrown = false;
+    try {
+        failing.get();
+    } catch (const std::runtime_error& e) {
+        thrown = std::string(e.what()) == "boom";
+    }
+    CHECK(thrown);
+
+    // Пул живий і після винятку в задачі.
+    CHECK(pool.submit([]() { return 7; }).get() == 7);
+}
+
+// Усі воркери зайняті: parallelFor має завершитися силами потоку виклику.
+void testParallelForCallerRuns() {
+    ThreadPool pool(2);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<unsigned int> blocked(0);
+    std::vector<std::future<void>> blockers;
+    for (unsigned int i = 0; i < pool.size(); ++i) {
+        blockers.push_back(pool.submit([released, &blocked]() {
+            blocked.fetch_add(1);
+            released.wait();
+        }));
+    }
+    while (blocked.load() < pool.size()) {
+        std::this_thread::yield();
+    }
+
+    const std::thread::id caller = std::this_thread::get_id();
+    std::vector<int> hits(1000, 0);
+    bool onlyCaller = true;
+    pool.parallelFor(0, hits.size(), [&](std::size_t lo, std::size_t hi) {
+        onlyCaller = onlyCaller && std::this_thread::get_id() == caller;
+        for (std::size_t i = lo; i < hi; ++i) {
+            ++hits[i];
+        }
+    }, 10);
+    CHECK(onlyCaller);
+    CHECK(std::all_of(hits.begin(), hits.end(), [](int h) { return h == 1; }));
+
+    release.set_value();
+    for (std::future<void>& blocker : blockers) {
+        blocker.get();
+    }
+
+    // Звичайний прогін з пулом і перекидання першого винятку.
+    std::vector<std::atomic<int>> counts(5000);
+    pool.parallelFor(0, counts.size(), [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t i = lo; i < hi; ++i) {
+            counts[i].fetch_add(1);
+        }
+    });
+    CHECK(std::all_of(counts.begin(), counts.end(), [](const std::atomic<int>& c) { return c.load() == 1; }));
+
+    bool thrown = false;
+    try {
+        pool.parallelFor(0, 100, [](std::size_t lo, std::size_t) {
+            if (lo == 50) {
+                throw std::runtime_error("chunk");
+            }
+        }, 10);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+}
+
+void testShutdown() {
+    ThreadPool pool(2);
+    std::atomic<int> ran(0);
+    for (int i = 0; i < 1000; ++i) {
+        pool.post([&ran]() { ran.fetch_add(1); });
+    }
+    // Уже поставлені задачі виконуються до кінця.
+    pool.shutdown();
+    CHECK(ran.load() == 1000);
+    CHECK(pool.pendingTasks() == 0);
+
+    // Після зупинки post виконує задачу одразу в потоці виклику.
+    std::thread::id runner;
+    pool.post([&runner]() { runner = std::this_thread::get_id(); });
+    CHECK(runner == std::this_thread::get_id());
+    CHECK(pool.submit([]() { return 1; }).get() == 1);
+
+    pool.shutdown();
+}
+
+} // namespace
+
+int main() {
+    testDequeOwnerVsThieves();
+    testNestedTasks();
+    testSubmit();
+    testParallelForCallerRuns();
+    testShutdown();
+    return test::result("thread_pool_test");
+}
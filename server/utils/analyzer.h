@@ -0,0 +1,246 @@
+#ifndef ANALYZER_H
+#define ANALYZER_H
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include <cstddef>
+
+#include "utf8.h"
+
+// Аналізатор тексту: токенізатор -> стоп-слова -> стемер. Ланки - параметри
+// шаблону зі статичними методами, тож для кожної конфігурації компілятор
+// збирає окремий цикл без віртуальних викликів, а порожні ланки (NoStopwords,
+// NoStemmer) зникають повністю. Ті самі ланки обробляють і документи, і
+// терми запитів, інакше слова не збігатимуться.
+//
+// Конфігурація за замовчуванням обирається під час збирання:
+//   CW_ANALYZER_ASCII     - лише ASCII (поведінка до підтримки UTF-8);
+//   CW_ANALYZER_UNICODE   - UTF-8, згортка регістру (за замовчуванням);
+//   CW_ANALYZER_UKRAINIAN - UTF-8 + українські стоп-слова й легкий стемер.
+namespace analysis {
+
+// Класи ASCII-байтів: мала літера/цифра або 0 (роздільник). Байти >= 0x80 - 0.
+struct AsciiClass {
+    unsigned char lower[256];
+};
+
+constexpr AsciiClass makeAsciiClass() {
+    AsciiClass table{};
+    for (int c = 0; c < 128; ++c) {
+        if (c >= 'A' && c <= 'Z') {
+            table.lower[c] = static_cast<unsigned char>(c + 32);
+        } else if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')) {
+            table.lower[c] = static_cast<unsigned char>(c);
+        }
+    }
+    return table;
+}
+
+inline constexpr AsciiClass kAsciiClass = makeAsciiClass();
+
+// Слова - послідовності ASCII-літер і цифр; решта байтів (зокрема весь UTF-8) - роздільники.
+struct AsciiTokenizer {
+    template <typename Emit>
+    static void tokenize(const std::string& text, std::string& token, Emit&& emit) {
+        token.clear();
+        for (char ch : text) {
+            unsigned char c = kAsciiClass.lower[static_cast<unsigned char>(ch)];
+            if (c != 0) {
+                token.push_back(static_cast<char>(c));
+            } else if (!token.empty()) {
+                emit(token);
+                token.clear();
+            }
+        }
+        if (!token.empty()) {
+            emit(token);
+            token.clear();
+        }
+    }
+};
+
+// UTF-8: ASCII-байти йдуть через ту саму таблицю, що й в AsciiTokenizer, і лише
+// багатобайтові символи декодуються. Апостроф між літерами лишається в слові
+// (м'ясо, don't) у вигляді ASCII '; м'який перенос і символи нульової ширини
+// ігноруються.
+struct Utf8Tokenizer {
+    template <typename Emit>
+    static void tokenize(const std::string& text, std::string& token, Emit&& emit) {
+        token.clear();
+        const char* p   = text.data();
+        const char* end = p + text.size();
+        bool     apostrophe = false;    // апостроф після літери, ще не доданий
+        char32_t last       = 0;        // останній символ токена
+
+        auto flush = [&]() {
+            if (!token.empty()) {
+                emit(token);
+                token.clear();
+            }
+            apostrophe = false;
+            last       = 0;
+        };
+
+        while (p < end) {
+            unsigned char b = static_cast<unsigned char>(*p);
+            if (b < 0x80) {
+                ++p;
+                unsigned char c = kAsciiClass.lower[b];
+                if (c != 0) {
+                    if (apostrophe) {
+                        token.push_back('\'');
+                        apostrophe = false;
+                    }
+                    token.push_back(static_cast<char>(c));
+                    last = c;
+                } else if (b == '\'' && !token.empty() && !apostrophe) {
+                    apostrophe = true;
+                } else {
+                    flush();
+                }
+                continue;
+            }
+
+            char32_t cp = 0;
+            p += utf8::decode(p, end, cp);
+            if (cp == 0xAD || (cp >= 0x200B && cp <= 0x200D) || cp == 0xFEFF) {
+                continue;
+            }
+            if (utf8::isApostrophe(cp)) {
+                if (!token.empty() && !apostrophe) {
+                    apostrophe = true;
+                } else {
+                    flush();
+                }
+                continue;
+            }
+            if (!utf8::isWordChar(cp)) {
+                flush();
+                continue;
+            }
+
+            cp = utf8::foldCase(cp);
+            if (!apostrophe) {
+                char32_t composed = utf8::composeCyrillic(last, cp);
+                if (composed != 0) {
+                    token.resize(token.size() - 2);     // база - двобайтова кирилиця
+                    utf8::append(token, composed);
+                    last = composed;
+                    continue;
+                }
+            }
+            if (apostrophe) {
+                token.push_back('\'');
+                apostrophe = false;
+            }
+            utf8::append(token, cp);
+            last = cp;
+        }
+        flush();
+    }
+};
+
+struct NoStopwords {
+    static bool isStopword(const std::string&) {
+        return false;
+    }
+};
+
+struct UkrainianStopwords {
+    static bool isStopword(const std::string& token) {
+        // Усі стоп-слова кириличні й короткі.
+        if (token.empty() || token.size() > 12 || static_cast<unsigned char>(token[0]) < 0x80) {
+            return false;
+        }
+        static const std::unordered_set<std::string> words = {
+            "а", "або", "але", "б", "би", "біля", "в", "вже", "від", "він", "вона", "вони",
+            "воно", "все", "де", "для", "до", "же", "ж", "з", "за", "зі", "і", "із", "й",
+            "крізь", "ми", "на", "над", "не", "ні", "о", "об", "по", "під", "при", "про",
+            "та", "так", "те", "ти", "то", "той", "ту", "у", "це", "цей", "ці", "ця",
+            "через", "чи", "що", "щоб", "як", "який", "яка", "яке", "які", "я",
+        };
+        return words.count(token) != 0;
+    }
+};
+
+struct NoStemmer {
+    static void stem(std::string&) {}
+};
+
+// Легкий стемер для української: відкидає одне найдовше флективне закінчення,
+// якщо від слова лишається щонайменше kMinStem літер. Чергування голосних у
+// корені (київ/києва) не обробляється. Некириличні слова не змінюються.
+struct UkrainianStemmer {
+    static constexpr std::size_t kMinStem = 3;
+
+    static void stem(std::string& token) {
+        if (token.empty()) {
+            return;
+        }
+        unsigned char lead = static_cast<unsigned char>(token[0]);
+        if (lead < 0xD0 || lead > 0xD2) {
+            return;
+        }
+        // Від довших до коротших; кирилична літера займає два байти.
+        static const char* const suffixes[] = {
+            "ього", "ьому",
+            "ами", "ями", "ові", "еві", "єві", "ого", "ому", "ими", "іми",
+            "ах", "ях", "ам", "ям", "ом", "ем", "єм", "ою", "ею", "єю",
+            "ий", "ій", "ої", "ів", "їв", "их", "іх", "им", "ім",
+            "а", "я", "о", "е", "є", "и", "і", "ї", "у", "ю", "ь",
+        };
+        std::size_t letters = utf8::length(token);
+        for (const char* suffix : suffixes) {
+            std::size_t bytes = std::char_traits<char>::length(suffix);
+            if (token.size() > bytes && letters >= kMinStem + bytes / 2
+                && token.compare(token.size() - bytes, bytes, suffix) == 0) {
+                token.resize(token.size() - bytes);
+                return;
+            }
+        }
+    }
+};
+
+template <typename Tokenizer, typename Stopwords = NoStopwords, typename Stemmer = NoStemmer>
+class Analyzer {
+public:
+    // emit(const std::string&) викликається для кожного терма у порядку тексту.
+    template <typename Emit>
+    static void analyze(const std::string& text, Emit&& emit) {
+        std::string token;
+        Tokenizer::tokenize(text, token, [&](std::string& term) {
+            if (Stopwords::isStopword(term)) {
+                return;
+            }
+            Stemmer::stem(term);
+            emit(static_cast<const std::string&>(term));
+        });
+    }
+
+    // Слово запиту може дати кілька термів ("foo-bar" -> foo, bar) - викликач
+    // поєднує їх через AND - або жодного (пунктуація, стоп-слово).
+    static std::vector<std::string> terms(const std::string& text) {
+        std::vector<std::string> out;
+        analyze(text, [&](const std::string& term) {
+            out.push_back(term);
+        });
+        return out;
+    }
+};
+
+typedef Analyzer<AsciiTokenizer>                                        AsciiAnalyzer;
+typedef Analyzer<Utf8Tokenizer>                                         UnicodeAnalyzer;
+typedef Analyzer<Utf8Tokenizer, UkrainianStopwords, UkrainianStemmer>   UkrainianAnalyzer;
+
+#if defined(CW_ANALYZER_ASCII)
+typedef AsciiAnalyzer DefaultAnalyzer;
+#elif defined(CW_ANALYZER_UKRAINIAN)
+typedef UkrainianAnalyzer DefaultAnalyzer;
+#else
+typedef UnicodeAnalyzer DefaultAnalyzer;
+#endif
+
+} // namespace analysis
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef BIT_UTILS_H
+#define BIT_UTILS_H
+
+#include <cstdint>
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
+inline unsigned int countTrailingZeros(std::uint64_t w) {
+#ifdef _MSC_VER
+    unsigned long index = 0;
+    _BitScanForward64(&index, w);
+    return static_cast<unsigned int>(index);
+#else
+    return static_cast<unsigned int>(__builtin_ctzll(w));
+#endif
+}
+
+inline unsigned int popCount(std::uint64_t w) {
+#ifdef _MSC_VER
+    return static_cast<unsigned int>(__popcnt64(w));
+#else
+    return static_cast<unsigned int>(__builtin_popcountll(w));
+#endif
+}
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef DEADLINE_H
+#define DEADLINE_H
+
+#include <atomic>
+#include <chrono>
+
+// Крайній термін запиту. Пошукові цикли перевіряють expired() між кроками
+// (слово, розділ об'єднання, вузол плану) і припиняють роботу, якщо час вийшов.
+// Після першого спрацювання результат запам'ятовується, тож повторні перевірки
+// з кількох потоків пулу не читають годинник. remainingMs() обмежує мережеві
+// очікування (координатор не чекає шард довше, ніж лишилось запиту).
+class Deadline {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    // Без обмеження часу.
+    Deadline()
+        : limited(false)
+        , when()
+        , hit(false)
+    {}
+
+    explicit Deadline(Clock::time_point when)
+        : limited(true)
+        , when(when)
+        , hit(false)
+    {}
+
+    Deadline(const Deadline&)            = delete;
+    Deadline& operator=(const Deadline&) = delete;
+    Deadline(Deadline&&)                 = delete;
+    Deadline& operator=(Deadline&&)      = delete;
+
+    bool isLimited() const {
+        return limited;
+    }
+
+    bool expired() const {
+        if (!limited) {
+            return false;
+        }
+        if (hit.load(std::memory_order_relaxed)) {
+            return true;
+        }
+        if (Clock::now() < when) {
+            return false;
+        }
+        hit.store(true, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Залишок у мілісекундах (0, якщо час вийшов; -1 - без обмеження).
+    long long remainingMs() const {
+        if (!limited) {
+            return -1;
+        }
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(when - Clock::now()).count();
+        return left > 0 ? left : 0;
+    }
+
+private:
+    bool                      limited;
+    Clock::time_point         when;
+    mutable std::atomic<bool> hit;
+};
+
+#endif
@@ -0,0 +1,268 @@
+#ifndef NUMA_TOPOLOGY_H
+#define NUMA_TOPOLOGY_H
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <thread>
+#include <cstdlib>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN     // інакше windows.h тягне winsock.h, що конфліктує з winsock2.h
+    #endif
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+// Топологія NUMA: вузли та їхні CPU.
+//   - Linux: /sys/devices/system/node/node*/cpulist, обмежені CPU, дозволеними
+//     процесу (sched_getaffinity: cpuset контейнера, taskset);
+//   - інакше (або якщо sysfs недоступний) - один вузол з усіма CPU,
+//     і все, що залежить від NUMA, стає no-op.
+// emulated(n) ділить наявні CPU на n штучних вузлів - для перевірки
+// NUMA-шляхів коду на одновузловій машині.
+
+struct NumaNode {
+    int              id = 0;
+    std::vector<int> cpus;
+};
+
+class NumaTopology {
+public:
+    static const NumaTopology& system() {
+        static const NumaTopology topology = detect();
+        return topology;
+    }
+
+    static NumaTopology detect() {
+        NumaTopology topology;
+    #ifndef _WIN32
+        std::ifstream online("/sys/devices/system/node/online");
+        std::string onlineList;
+        if (online && std::getline(online, onlineList)) {
+            for (int node : parseCpuList(onlineList)) {
+                std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+                std::string list;
+                if (!in || !std::getline(in, list)) {
+                    continue;
+                }
+                NumaNode entry;
+                entry.id   = node;
+                entry.cpus = allowedOnly(parseCpuList(list));
+                // Вузли лише з пам'яттю (без CPU) для розміщення потоків не потрібні.
+                if (!entry.cpus.empty()) {
+                    topology.nodes.push_back(entry);
+                }
+            }
+        }
+    #endif
+        if (topology.nodes.empty()) {
+            topology.nodes.push_back(allCpusNode());
+        }
+        return topology;
+    }
+
+    static NumaTopology emulated(unsigned int nodeCount) {
+        NumaTopology topology;
+        NumaNode all = allCpusNode();
+        if (nodeCount <= 1) {
+            topology.nodes.push_back(all);
+            return topology;
+        }
+        for (unsigned int i = 0; i < nodeCount; ++i) {
+            NumaNode node;
+            node.id = static_cast<int>(i);
+            topology.nodes.push_back(node);
+        }
+        // CPU розподіляються суцільними блоками; якщо CPU менше за вузли - повторюються.
+        std::size_t total = all.cpus.size();
+        for (std::size_t i = 0; i < std::max<std::size_t>(total, nodeCount); ++i) {
+            std::size_t nodeIndex = i * nodeCount / std::max<std::size_t>(total, nodeCount);
+            topology.nodes[nodeIndex].cpus.push_back(all.cpus[i % total]);
+        }
+        return topology;
+    }
+
+    // "0-3,8,10-11" -> {0,1,2,3,8,10,11} (формат cpulist і node/online)
+    static std::vector<int> parseCpuList(const std::string& list) {
+        std::vector<int> cpus;
+        std::size_t pos = 0;
+        while (pos < list.size()) {
+            std::size_t comma = list.find(',', pos);
+            if (comma == std::string::npos) {
+                comma = list.size();
+            }
+            std::string item = list.substr(pos, comma - pos);
+            std::size_t dash = item.find('-');
+            if (!item.empty() && item.find_first_not_of("0123456789-\r\n ") == std::string::npos) {
+                int first = std::atoi(item.c_str());
+                int last  = dash == std::string::npos ? first : std::atoi(item.c_str() + dash + 1);
+                for (int cpu = first; cpu <= last; ++cpu) {
+                    cpus.push_back(cpu);
+                }
+            }
+            pos = comma + 1;
+        }
+        return cpus;
+    }
+
+    std::size_t nodeCount() const {
+        return nodes.size();
+    }
+
+    bool isMultiNode() const {
+        return nodes.size() > 1;
+    }
+
+    const NumaNode& node(std::size_t index) const {
+        return nodes[index];
+    }
+
+    // Індекс вузла (0..nodeCount-1), якому належить CPU; 0, якщо невідомо.
+    std::size_t nodeOfCpu(int cpu) const {
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            for (int c : nodes[i].cpus) {
+                if (c == cpu) {
+                    return i;
+                }
+            }
+        }
+        return 0;
+    }
+
+    // Вузол поточного потоку: підказка, встановлена при закріпленні,
+    // інакше - вузол CPU, на якому потік виконується зараз.
+    std::size_t currentNode() const {
+        if (!isMultiNode()) {
+            return 0;
+        }
+        int hint = threadNodeHint();
+        if (hint >= 0 && static_cast<std::size_t>(hint) < nodes.size()) {
+            return static_cast<std::size_t>(hint);
+        }
+    #if defined(__linux__)
+        int cpu = sched_getcpu();
+        return cpu >= 0 ? nodeOfCpu(cpu) : 0;
+    #else
+        return 0;
+    #endif
+    }
+
+    // Закріплює поточний потік за набором CPU. false, якщо ОС не дозволила.
+    static bool pinCurrentThread(const std::vector<int>& cpus) {
+        if (cpus.empty()) {
+            return false;
+        }
+    #if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : cpus) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &set);
+            }
+        }
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+    #elif defined(_WIN32)
+        DWORD_PTR mask = 0;
+        for (int cpu : cpus) {
+            if (cpu >= 0 && cpu < static_cast<int>(sizeof(DWORD_PTR) * 8)) {
+                mask |= static_cast<DWORD_PTR>(1) << cpu;
+            }
+        }
+        return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+    #else
+        return false;
+    #endif
+    }
+
+    // Закріплює потік за вузлом і запам'ятовує вузол для currentNode().
+    bool pinCurrentThreadToNode(std::size_t index) const {
+        setThreadNodeHint(static_cast<int>(index));
+        if (!isMultiNode()) {
+            return true;
+        }
+        return pinCurrentThread(nodes[index].cpus);
+    }
+
+    static void setThreadNodeHint(int index) {
+        threadNodeHintRef() = index;
+    }
+
+    static int threadNodeHint() {
+        return threadNodeHintRef();
+    }
+
+private:
+    // CPU, на яких процесу дозволено виконуватись. Номери не обов'язково
+    // суцільні (taskset -c 2,5-7), тож 0..N-1 за hardware_concurrency не годиться.
+    // Порожньо, якщо ОС не повідомила маску.
+    static std::vector<int> allowedCpus() {
+        std::vector<int> cpus;
+    #if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &set)) {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+    #elif defined(_WIN32)
+        DWORD_PTR processMask = 0;
+        DWORD_PTR systemMask  = 0;
+        if (GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask) != 0) {
+            for (int cpu = 0; cpu < static_cast<int>(sizeof(DWORD_PTR) * 8); ++cpu) {
+                if ((processMask >> cpu) & 1) {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+    #endif
+        return cpus;
+    }
+
+    // CPU вузла, дозволені процесу; якщо маска невідома - без змін.
+    static std::vector<int> allowedOnly(const std::vector<int>& cpus) {
+        std::vector<int> allowed = allowedCpus();
+        if (allowed.empty()) {
+            return cpus;
+        }
+        std::vector<int> out;
+        for (int cpu : cpus) {
+            if (std::binary_search(allowed.begin(), allowed.end(), cpu)) {
+                out.push_back(cpu);
+            }
+        }
+        return out;
+    }
+
+    static NumaNode allCpusNode() {
+        NumaNode node;
+        node.cpus = allowedCpus();
+        if (node.cpus.empty()) {
+            unsigned int count = std::thread::hardware_concurrency();
+            for (unsigned int cpu = 0; cpu < std::max(count, 1u); ++cpu) {
+                node.cpus.push_back(static_cast<int>(cpu));
+            }
+        }
+        return node;
+    }
+
+    static int& threadNodeHintRef() {
+        static thread_local int hint = -1;
+        return hint;
+    }
+
+private:
+    std::vector<NumaNode> nodes;
+};
+
+#endif
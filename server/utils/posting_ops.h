@@ -0,0 +1,216 @@
+#ifndef POSTING_OPS_H
+#define POSTING_OPS_H
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "thread_pool.h"
+#include "posting_list.h"
+#include "bit_utils.h"
+#include "deadline.h"
+
+// Ядра операцій над списками docId.
+// Об'єднання ділиться на діапазони docId, кожен діапазон рахується окремо,
+// а результати склеюються вже в порядку зростання docId.
+
+namespace posting_ops {
+
+// Менше цього сумарного числа записів паралелити не варто.
+constexpr std::size_t kParallelUnionThreshold = 1u << 15;
+constexpr std::size_t kParallelSortThreshold  = 1u << 14;
+// На скільки шматків ділиться діапазон docId у послідовному об'єднанні
+// (між шматками перевіряється deadline).
+constexpr unsigned int kSequentialUnionSlices = 16;
+
+using PostingRefs = std::vector<const PostingList*>;
+
+// Об'єднання частин списків, що лежать у [lo, hi), через бітову мапу.
+// Щільні контейнери вливаються цілими словами.
+inline void unionRangeBitmap(const PostingRefs& lists,
+                             unsigned int lo, unsigned int hi,
+                             std::vector<unsigned int>& out) {
+    std::size_t width = static_cast<std::size_t>(hi - lo);
+    std::vector<std::uint64_t> bits((width + 63) / 64, 0);
+
+    for (const PostingList* list : lists) {
+        list->orIntoBitmap(lo, hi, bits.data());
+    }
+
+    for (std::size_t word = 0; word < bits.size(); ++word) {
+        std::uint64_t w = bits[word];
+        while (w != 0) {
+            unsigned int bit = countTrailingZeros(w);
+            out.push_back(lo + static_cast<unsigned int>(word * 64) + bit);
+            w &= w - 1;
+        }
+    }
+}
+
+// Об'єднання частин списків, що лежать у [lo, hi), попарним злиттям.
+inline void unionRangeMerge(const PostingRefs& lists,
+                            unsigned int lo, unsigned int hi,
+                            std::vector<unsigned int>& out) {
+    std::vector<unsigned int> merged;
+    std::vector<unsigned int> part;
+    std::vector<unsigned int> tmp;
+
+    for (const PostingList* list : lists) {
+        part.clear();
+        list->appendRange(lo, hi, part);
+        if (part.empty()) {
+            continue;
+        }
+
+        tmp.clear();
+        tmp.reserve(merged.size() + part.size());
+        std::set_union(merged.begin(), merged.end(), part.begin(), part.end(), std::back_inserter(tmp));
+        merged.swap(tmp);
+    }
+
+    out.insert(out.end(), merged.begin(), merged.end());
+}
+
+// Об'єднання списків. Результат відсортований за docId.
+// pool може бути nullptr - тоді все рахується у потоці виклику.
+// Якщо deadline вийшов, out лишається порожнім (перевірка між розділами,
+// і в паралельному, і в послідовному шляху).
+inline void unionPostings(const PostingRefs& lists,
+                          std::vector<unsigned int>& out,
+                          ThreadPool* pool,
+                          const Deadline* deadline = nullptr) {
+    out.clear();
+    if (lists.empty()) {
+        return;
+    }
+    if (lists.size() == 1) {
+        lists.front()->toVector(out);
+        return;
+    }
+
+    std::size_t  total = 0;
+    unsigned int upper = 0;
+    for (const PostingList* list : lists) {
+        total += list->cardinality();
+        if (!list->empty() && list->maxDocId() + 1 > upper) {
+            upper = list->maxDocId() + 1;
+        }
+    }
+
+    // Щільне об'єднання (у середньому більше ніж 1 запис на 32 docId)
+    // або багато списків вигідніше рахувати бітовою мапою.
+    bool useBitmap = total * 32 >= upper || lists.size() > 8;
+    auto unionRange = [&](unsigned int lo, unsigned int hi, std::vector<unsigned int>& dst) {
+        if (useBitmap) {
+            unionRangeBitmap(lists, lo, hi, dst);
+        } else {
+            unionRangeMerge(lists, lo, hi, dst);
+        }
+    };
+
+    auto expired = [deadline]() { return deadline != nullptr && deadline->expired(); };
+
+    if (pool == nullptr || pool->size() == 1 || total < kParallelUnionThreshold) {
+        unsigned int step = (upper + kSequentialUnionSlices - 1) / kSequentialUnionSlices;
+        step = std::max((step + 63) & ~63u, 64u);
+        for (std::uint64_t lo = 0; lo < upper; lo += step) {
+            if (expired()) {
+                out.clear();
+                return;
+            }
+            std::uint64_t hi = std::min<std::uint64_t>(lo + step, upper);
+            unionRange(static_cast<unsigned int>(lo), static_cast<unsigned int>(hi), out);
+        }
+        return;
+    }
+
+    std::size_t partitions = static_cast<std::size_t>(pool->size()) * 2;
+    unsigned int step = static_cast<unsigned int>((upper + partitions - 1) / partitions);
+    step = (step + 63) & ~63u;
+
+    std::vector<std::vector<unsigned int>> parts(partitions);
+    pool->parallelFor(0, partitions, [&](std::size_t pLo, std::size_t pHi) {
+        for (std::size_t p = pLo; p < pHi; ++p) {
+            std::uint64_t lo = static_cast<std::uint64_t>(p) * step;
+            std::uint64_t hi = lo + step;
+            if (lo >= upper || expired()) {
+                continue;
+            }
+            if (hi > upper) {
+                hi = upper;
+            }
+            unionRange(static_cast<unsigned int>(lo), static_cast<unsigned int>(hi), parts[p]);
+        }
+    }, 1);
+
+    if (expired()) {
+        return;
+    }
+
+    std::vector<std::size_t> offsets(partitions + 1, 0);
+    for (std::size_t p = 0; p < partitions; ++p) {
+        offsets[p + 1] = offsets[p] + parts[p].size();
+    }
+
+    out.resize(offsets[partitions]);
+    pool->parallelFor(0, partitions, [&](std::size_t pLo, std::size_t pHi) {
+        for (std::size_t p = pLo; p < pHi; ++p) {
+            std::copy(parts[p].begin(), parts[p].end(), out.begin() + static_cast<std::ptrdiff_t>(offsets[p]));
+        }
+    }, 1);
+}
+
+// Паралельне сортування: шматки сортуються незалежно,
+// потім зливаються попарно, кожен рівень злиттів - паралельно.
+template <typename T, typename Less = std::less<T>>
+void parallelSort(std::vector<T>& values, ThreadPool* pool, Less less = Less()) {
+    if (pool == nullptr || pool->size() == 1 || values.size() < kParallelSortThreshold) {
+        std::sort(values.begin(), values.end(), less);
+        return;
+    }
+
+    std::size_t chunks = pool->size();
+    std::size_t chunkSize = (values.size() + chunks - 1) / chunks;
+
+    std::vector<std::size_t> bounds;
+    for (std::size_t pos = 0; pos < values.size(); pos += chunkSize) {
+        bounds.push_back(pos);
+    }
+    bounds.push_back(values.size());
+
+    pool->parallelFor(0, bounds.size() - 1, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t i = lo; i < hi; ++i) {
+            std::sort(values.begin() + static_cast<std::ptrdiff_t>(bounds[i]),
+                      values.begin() + static_cast<std::ptrdiff_t>(bounds[i + 1]),
+                      less);
+        }
+    }, 1);
+
+    while (bounds.size() > 2) {
+        std::size_t pairs = (bounds.size() - 1) / 2;
+        pool->parallelFor(0, pairs, [&](std::size_t lo, std::size_t hi) {
+            for (std::size_t i = lo; i < hi; ++i) {
+                std::inplace_merge(values.begin() + static_cast<std::ptrdiff_t>(bounds[2 * i]),
+                                   values.begin() + static_cast<std::ptrdiff_t>(bounds[2 * i + 1]),
+                                   values.begin() + static_cast<std::ptrdiff_t>(bounds[2 * i + 2]),
+                                   less);
+            }
+        }, 1);
+
+        std::vector<std::size_t> next;
+        for (std::size_t i = 0; i < bounds.size(); i += 2) {
+            next.push_back(bounds[i]);
+        }
+        if (next.back() != values.size()) {
+            next.push_back(values.size());
+        }
+        bounds.swap(next);
+    }
+}
+
+} // namespace posting_ops
+
+#endif
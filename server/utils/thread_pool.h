@@ -0,0 +1,420 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "concurrent_queue.h"
+#include "work_stealing_deque.h"
+#include "numa_topology.h"
+
+// Пул потоків з крадіжкою роботи.
+//   - кожен робочий потік має власний дек Chase-Lev;
+//   - задачі, створені зовні пулу, потрапляють у спільну чергу;
+//   - задачі, створені всередині пулу, кладуться у дек поточного потоку;
+//   - вільний потік спершу бере свою роботу, потім спільну, потім краде в інших
+//     (при закріпленні - спершу в потоків свого NUMA-вузла).
+
+// Закріплення робочих потоків:
+//   None - без affinity (як раніше);
+//   Node - потоки розкладаються по вузлах по колу, кожен закріплений за CPU свого вузла;
+//   Cpu  - те саме, але кожен потік закріплений за одним CPU.
+enum class WorkerPinning {
+    None,
+    Node,
+    Cpu
+};
+
+class ThreadPool {
+public:
+    struct WorkerStats {
+        std::uint64_t executed    = 0;
+        std::uint64_t stolen      = 0;
+        std::uint64_t fromShared  = 0;
+        std::uint64_t localPushes = 0;
+        std::uint64_t failed      = 0;
+        std::uint64_t sleeps      = 0;
+        int           node        = -1;     // вузол закріплення, -1 - не закріплений
+        int           cpu         = -1;     // CPU для WorkerPinning::Cpu
+    };
+
+    explicit ThreadPool(unsigned int threadCount = 0,
+                        WorkerPinning pinning = WorkerPinning::None,
+                        const NumaTopology& topology = NumaTopology::system())
+        : pending(0)
+        , stopping(false)
+        , stopped(false)
+        , pinning(pinning)
+        , numa(topology)
+    {
+        if (threadCount == 0) {
+            threadCount = std::thread::hardware_concurrency();
+        }
+        if (threadCount == 0) {
+            threadCount = 1;
+        }
+
+        workers.reserve(threadCount);
+        for (unsigned int i = 0; i < threadCount; ++i) {
+            workers.push_back(std::make_unique<Worker>());
+        }
+        assignPlacement();
+        for (unsigned int i = 0; i < threadCount; ++i) {
+            workers[i]->thread = std::thread(&ThreadPool::workerLoop, this, i);
+        }
+    }
+
+    ~ThreadPool() {
+        shutdown();
+    }
+
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ThreadPool(ThreadPool&&)                 = delete;
+    ThreadPool& operator=(ThreadPool&&)      = delete;
+
+    unsigned int size() const {
+        return static_cast<unsigned int>(workers.size());
+    }
+
+    // Задача без результату. Після shutdown() виконується в потоці виклику.
+    void post(std::function<void()> fn) {
+        if (stopping.load(std::memory_order_acquire)) {
+            runTask(fn, nullptr);
+            return;
+        }
+
+        Task* task = new Task{std::move(fn)};
+        pending.fetch_add(1, std::memory_order_release);
+
+        int index = currentWorkerIndex();
+        if (index >= 0) {
+            workers[index]->deque.push(task);
+            workers[index]->localPushes.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            sharedQueue.push(task);
+        }
+
+        wakeOne();
+    }
+
+    template <typename F, typename... Args>
+    auto submit(F&& fn, Args&&... args)
+        -> std::future<typename std::invoke_result<F, Args...>::type>
+    {
+        using Result = typename std::invoke_result<F, Args...>::type;
+
+        auto task = std::make_shared<std::packaged_task<Result()>>(
+            std::bind(std::forward<F>(fn), std::forward<Args>(args)...)
+        );
+        std::future<Result> future = task->get_future();
+        post([task]() { (*task)(); });
+        return future;
+    }
+
+    // Ділить [begin, end) на шматки по grain елементів і викликає body(lo, hi).
+    // Потік виклику сам обробляє шматки, тому виклик з робочого потоку
+    // пулу не блокує його назавжди. Перший виняток перекидається викликачу.
+    template <typename Body>
+    void parallelFor(std::size_t begin, std::size_t end, Body&& body, std::size_t grain = 0) {
+        if (begin >= end) {
+            return;
+        }
+
+        std::size_t total = end - begin;
+        if (grain == 0) {
+            std::size_t parts = static_cast<std::size_t>(size()) * 4;
+            grain = (total + parts - 1) / parts;
+        }
+        if (grain == 0) {
+            grain = 1;
+        }
+
+        std::size_t chunkCount = (total + grain - 1) / grain;
+        if (chunkCount == 1 || size() == 1) {
+            body(begin, end);
+            return;
+        }
+
+        struct LoopState {
+            std::atomic<std::size_t> nextChunk{0};
+            std::atomic<std::size_t> doneChunks{0};
+            std::mutex               mutex;
+            std::condition_variable  cv;
+            std::exception_ptr       error;
+        };
+
+        auto state = std::make_shared<LoopState>();
+        std::function<void(std::size_t, std::size_t)> rangeBody = std::forward<Body>(body);
+
+        auto drain = [state, rangeBody, begin, end, grain, chunkCount]() {
+            for (;;) {
+                std::size_t chunk = state->nextChunk.fetch_add(1, std::memory_order_relaxed);
+                if (chunk >= chunkCount) {
+                    return;
+                }
+
+                std::size_t lo = begin + chunk * grain;
+                std::size_t hi = lo + grain < end ? lo + grain : end;
+                try {
+                    rangeBody(lo, hi);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    if (!state->error) {
+                        state->error = std::current_exception();
+                    }
+                }
+
+                if (state->doneChunks.fetch_add(1, std::memory_order_acq_rel) + 1 == chunkCount) {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    state->cv.notify_all();
+                }
+            }
+        };
+
+        std::size_t helpers = chunkCount - 1;
+        if (helpers > size()) {
+            helpers = size();
+        }
+        for (std::size_t i = 0; i < helpers; ++i) {
+            post(drain);
+        }
+
+        drain();
+
+        {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->cv.wait(lock, [&]() {
+                return state->doneChunks.load(std::memory_order_acquire) == chunkCount;
+            });
+        }
+
+        if (state->error) {
+            std::rethrow_exception(state->error);
+        }
+    }
+
+    // Зупиняє пул. Задачі, що вже в чергах, виконуються до кінця.
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            if (stopped) {
+                return;
+            }
+            stopped = true;
+            stopping.store(true, std::memory_order_release);
+        }
+        sleepCv.notify_all();
+
+        for (auto& worker : workers) {
+            if (worker->thread.joinable()) {
+                worker->thread.join();
+            }
+        }
+
+        // Задачі, що встигли потрапити у спільну чергу під час зупинки.
+        Task* task = nullptr;
+        while (sharedQueue.try_pop(task)) {
+            pending.fetch_sub(1, std::memory_order_acq_rel);
+            runTask(task->fn, nullptr);
+            delete task;
+        }
+    }
+
+    std::vector<WorkerStats> getWorkerStats() const {
+        std::vector<WorkerStats> stats;
+        stats.reserve(workers.size());
+        for (const auto& worker : workers) {
+            WorkerStats s;
+            s.executed    = worker->executed.load(std::memory_order_relaxed);
+            s.stolen      = worker->stolen.load(std::memory_order_relaxed);
+            s.fromShared  = worker->fromShared.load(std::memory_order_relaxed);
+            s.localPushes = worker->localPushes.load(std::memory_order_relaxed);
+            s.failed      = worker->failed.load(std::memory_order_relaxed);
+            s.sleeps      = worker->sleeps.load(std::memory_order_relaxed);
+            s.node        = worker->node;
+            s.cpu         = worker->cpu;
+            stats.push_back(s);
+        }
+        return stats;
+    }
+
+    std::size_t pendingTasks() const {
+        return static_cast<std::size_t>(pending.load(std::memory_order_relaxed));
+    }
+
+    const NumaTopology& topology() const {
+        return numa;
+    }
+
+    // Індекс робочого потоку цього пулу або -1 для сторонніх потоків.
+    int currentWorkerIndex() const {
+        return tlsPool == this ? tlsWorkerIndex : -1;
+    }
+
+private:
+    struct Task {
+        std::function<void()> fn;
+    };
+
+    struct alignas(64) Worker {
+        WorkStealingDeque<Task*>   deque;
+        std::thread                thread;
+        std::atomic<std::uint64_t> executed{0};
+        std::atomic<std::uint64_t> stolen{0};
+        std::atomic<std::uint64_t> fromShared{0};
+        std::atomic<std::uint64_t> localPushes{0};
+        std::atomic<std::uint64_t> failed{0};
+        std::atomic<std::uint64_t> sleeps{0};
+        int                        node = -1;
+        int                        cpu  = -1;
+        std::vector<std::size_t>   victims;     // порядок крадіжки
+    };
+
+    // Вузол і CPU кожного потоку та порядок крадіжки: спершу свій вузол.
+    void assignPlacement() {
+        std::size_t count     = workers.size();
+        std::size_t nodeCount = numa.nodeCount();
+        bool pinned = pinning != WorkerPinning::None;
+
+        for (std::size_t i = 0; i < count; ++i) {
+            Worker& w = *workers[i];
+            if (pinned) {
+                w.node = static_cast<int>(i % nodeCount);
+                if (pinning == WorkerPinning::Cpu) {
+                    const std::vector<int>& cpus = numa.node(static_cast<std::size_t>(w.node)).cpus;
+                    w.cpu = cpus[(i / nodeCount) % cpus.size()];
+                }
+            }
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            Worker& w = *workers[i];
+            for (int pass = 0; pass < 2; ++pass) {
+                for (std::size_t offset = 1; offset < count; ++offset) {
+                    std::size_t victim = (i + offset) % count;
+                    bool sameNode = workers[victim]->node == w.node;
+                    if ((pass == 0) == sameNode) {
+                        w.victims.push_back(victim);
+                    }
+                }
+            }
+        }
+    }
+
+    void pinCurrentWorker(const Worker& self) {
+        if (self.cpu >= 0) {
+            NumaTopology::setThreadNodeHint(self.node);
+            NumaTopology::pinCurrentThread(std::vector<int>(1, self.cpu));
+        } else if (self.node >= 0) {
+            numa.pinCurrentThreadToNode(static_cast<std::size_t>(self.node));
+        }
+    }
+
+    void workerLoop(unsigned int index) {
+        tlsPool        = this;
+        tlsWorkerIndex = static_cast<int>(index);
+        Worker& self   = *workers[index];
+        pinCurrentWorker(self);
+
+        for (;;) {
+            Task* task = nullptr;
+            if (findTask(index, task)) {
+                pending.fetch_sub(1, std::memory_order_acq_rel);
+                runTask(task->fn, &self);
+                delete task;
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            if (pending.load(std::memory_order_acquire) > 0) {
+                continue;
+            }
+            if (stopping.load(std::memory_order_acquire)) {
+                break;
+            }
+            self.sleeps.fetch_add(1, std::memory_order_relaxed);
+            sleepCv.wait(lock, [this]() {
+                return pending.load(std::memory_order_acquire) > 0
+                    || stopping.load(std::memory_order_acquire);
+            });
+        }
+
+        tlsPool        = nullptr;
+        tlsWorkerIndex = -1;
+    }
+
+    bool findTask(unsigned int index, Task*& outTask) {
+        Worker& self = *workers[index];
+
+        if (self.deque.pop(outTask)) {
+            return true;
+        }
+
+        if (sharedQueue.try_pop(outTask)) {
+            self.fromShared.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        for (std::size_t victimIndex : self.victims) {
+            Worker& victim = *workers[victimIndex];
+            if (victim.deque.steal(outTask)) {
+                self.stolen.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void runTask(std::function<void()>& fn, Worker* worker) {
+        try {
+            fn();
+        } catch (...) {
+            if (worker != nullptr) {
+                worker->failed.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        if (worker != nullptr) {
+            worker->executed.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void wakeOne() {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        sleepCv.notify_one();
+    }
+
+private:
+    std::vector<std::unique_ptr<Worker>> workers;
+    ConcurrentQueue<Task*>               sharedQueue;
+
+    std::atomic<std::int64_t> pending;
+    std::atomic<bool>         stopping;
+    bool                      stopped;
+
+    std::mutex              sleepMutex;
+    std::condition_variable sleepCv;
+
+    WorkerPinning pinning;
+    NumaTopology  numa;
+
+    static thread_local const ThreadPool* tlsPool;
+    static thread_local int               tlsWorkerIndex;
+};
+
+inline thread_local const ThreadPool* ThreadPool::tlsPool        = nullptr;
+inline thread_local int               ThreadPool::tlsWorkerIndex = -1;
+
+#endif
@@ -0,0 +1,223 @@
+#ifndef UTF8_H
+#define UTF8_H
+
+#include <string>
+#include <cstddef>
+
+// Мінімальна робота з UTF-8 для аналізатора тексту: декодер, кодер, прості
+// відображення регістру та класи символів. Повних таблиць Unicode немає -
+// відображення регістру покривають латиницю, грецьку та кирилицю, а межі слів
+// визначаються за діапазонами розділових знаків і символів.
+namespace utf8 {
+
+constexpr char32_t kReplacement = 0xFFFD;
+
+// Декодує один символ з [p, end). Повертає кількість спожитих байтів (>= 1).
+// Некоректна послідовність дає U+FFFD і споживає один байт.
+inline std::size_t decode(const char* p, const char* end, char32_t& outCp) {
+    unsigned char b0 = static_cast<unsigned char>(p[0]);
+    if (b0 < 0x80) {
+        outCp = b0;
+        return 1;
+    }
+
+    std::size_t length = 0;
+    char32_t    cp     = 0;
+    char32_t    minCp  = 0;
+    if ((b0 & 0xE0) == 0xC0) {
+        length = 2;
+        cp     = b0 & 0x1F;
+        minCp  = 0x80;
+    } else if ((b0 & 0xF0) == 0xE0) {
+        length = 3;
+        cp     = b0 & 0x0F;
+        minCp  = 0x800;
+    } else if ((b0 & 0xF8) == 0xF0) {
+        length = 4;
+        cp     = b0 & 0x07;
+        minCp  = 0x10000;
+    } else {
+        outCp = kReplacement;
+        return 1;
+    }
+
+    if (static_cast<std::size_t>(end - p) < length) {
+        outCp = kReplacement;
+        return 1;
+    }
+    for (std::size_t i = 1; i < length; ++i) {
+        unsigned char b = static_cast<unsigned char>(p[i]);
+        if ((b & 0xC0) != 0x80) {
+            outCp = kReplacement;
+            return 1;
+        }
+        cp = (cp << 6) | (b & 0x3F);
+    }
+    // Надлишкові форми, сурогати та значення поза Unicode.
+    if (cp < minCp || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+        outCp = kReplacement;
+        return 1;
+    }
+    outCp = cp;
+    return length;
+}
+
+inline void append(std::string& out, char32_t cp) {
+    if (cp < 0x80) {
+        out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+// Кількість символів у коректному UTF-8.
+inline std::size_t length(const std::string& s) {
+    std::size_t count = 0;
+    for (char ch : s) {
+        if ((static_cast<unsigned char>(ch) & 0xC0) != 0x80) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+// Проста (один символ -> один символ) згортка регістру.
+inline char32_t foldCase(char32_t cp) {
+    if (cp < 0x80) {
+        return (cp >= 'A' && cp <= 'Z') ? cp + 32 : cp;
+    }
+    if (cp < 0x100) {
+        return (cp >= 0xC0 && cp <= 0xDE && cp != 0xD7) ? cp + 32 : cp;
+    }
+    if (cp < 0x180) {                                   // Latin Extended-A
+        if (cp == 0x130) {
+            return 'i';
+        }
+        if (cp == 0x178) {
+            return 0xFF;
+        }
+        if (cp == 0x17F) {
+            return 's';
+        }
+        if ((cp <= 0x137) || (cp >= 0x14A && cp <= 0x177)) {
+            return cp | 1;
+        }
+        if ((cp >= 0x139 && cp <= 0x148) || (cp >= 0x179 && cp <= 0x17E)) {
+            return (cp & 1) != 0 ? cp + 1 : cp;
+        }
+        return cp;
+    }
+    if (cp >= 0x370 && cp < 0x400) {                    // грецька
+        if (cp >= 0x391 && cp <= 0x3A9 && cp != 0x3A2) {
+            return cp + 32;
+        }
+        if (cp == 0x3C2) {
+            return 0x3C3;                               // кінцева сигма
+        }
+        if (cp == 0x386) {
+            return 0x3AC;
+        }
+        if (cp >= 0x388 && cp <= 0x38A) {
+            return cp + 37;
+        }
+        if (cp == 0x38C) {
+            return 0x3CC;
+        }
+        if (cp == 0x38E || cp == 0x38F) {
+            return cp + 63;
+        }
+        return cp;
+    }
+    if (cp >= 0x400 && cp < 0x530) {                    // кирилиця
+        if (cp < 0x410) {
+            return cp + 80;                             // Ѐ..Џ, зокрема Є, І, Ї
+        }
+        if (cp < 0x430) {
+            return cp + 32;
+        }
+        if ((cp >= 0x460 && cp <= 0x481) || (cp >= 0x48A && cp <= 0x4BF) || cp >= 0x4D0) {
+            return cp | 1;                              // пари, зокрема Ґ/ґ
+        }
+        if (cp == 0x4C0) {
+            return 0x4CF;
+        }
+        if (cp >= 0x4C1 && cp <= 0x4CE) {
+            return (cp & 1) != 0 ? cp + 1 : cp;
+        }
+        return cp;
+    }
+    if (cp >= 0x1E00 && cp <= 0x1EFF && (cp < 0x1E96 || cp > 0x1E9F)) {
+        return cp | 1;                                  // Latin Extended Additional
+    }
+    if (cp >= 0xFF21 && cp <= 0xFF3A) {
+        return cp + 32;                                 // повноширинні A..Z
+    }
+    return cp;
+}
+
+// Апострофи всередині слова (м'ясо, don't) зводяться до ASCII '.
+inline bool isApostrophe(char32_t cp) {
+    return cp == '\'' || cp == 0x2019 || cp == 0x02BC;
+}
+
+// Літера, цифра чи комбінований знак. Поза ASCII символ вважається частиною
+// слова, якщо не потрапляє в діапазони пробілів, розділових знаків і символів.
+inline bool isWordChar(char32_t cp) {
+    if (cp < 0x80) {
+        return (cp >= 'a' && cp <= 'z') || (cp >= 'A' && cp <= 'Z') || (cp >= '0' && cp <= '9');
+    }
+    if (cp < 0xC0) {
+        return cp == 0xAA || cp == 0xB5 || cp == 0xBA;  // ª µ º
+    }
+    if (cp == 0xD7 || cp == 0xF7) {
+        return false;                                   // × ÷
+    }
+    if (cp == 0x37E || cp == 0x387 || cp == 0x482) {
+        return false;                                   // грецькі ; · та кириличний ҂
+    }
+    if (cp >= 0x2000 && cp <= 0x2BFF) {
+        return false;                                   // пунктуація, валюти, стрілки, математика
+    }
+    if ((cp >= 0x3000 && cp <= 0x303F) || (cp >= 0xFE30 && cp <= 0xFE6F)) {
+        return false;                                   // CJK та малі форми пунктуації
+    }
+    if ((cp >= 0xFF00 && cp <= 0xFF0F) || (cp >= 0xFF1A && cp <= 0xFF20)
+        || (cp >= 0xFF3B && cp <= 0xFF40) || (cp >= 0xFF5B && cp <= 0xFF65)) {
+        return false;                                   // повноширинна пунктуація
+    }
+    if ((cp >= 0xE000 && cp <= 0xF8FF) || (cp >= 0xFFF0 && cp <= 0xFFFF)) {
+        return false;                                   // приватні, спеціальні, U+FFFD
+    }
+    if (cp >= 0x1F000 && cp <= 0x1FAFF) {
+        return false;                                   // емодзі та піктограми
+    }
+    return true;
+}
+
+// Канонічне поєднання базової кириличної літери з комбінованим знаком
+// (и + ◌̆ -> й, і + ◌̈ -> ї), щоб розкладені форми давали той самий терм.
+// 0, якщо пари немає.
+inline char32_t composeCyrillic(char32_t base, char32_t mark) {
+    if (mark == 0x306) {
+        if (base == 0x438) return 0x439;                // й
+        if (base == 0x443) return 0x45E;                // ў
+    } else if (mark == 0x308) {
+        if (base == 0x456) return 0x457;                // ї
+        if (base == 0x435) return 0x451;                // ё
+    }
+    return 0;
+}
+
+} // namespace utf8
+
+#endif